@@ -6,8 +6,10 @@
 #include <limits>
 #include <map>
 #include <string>
+#include <utility>
 
 #include "solver/algorithm/algorithm.h"
+#include "solver/encoder/binary.h"
 #include "solver/encoder/dimacs.h"
 
 namespace fs = std::filesystem;
@@ -21,13 +23,39 @@ int main(int argc, char *argv[]) {
   std::string solverID(argv[1]);
   std::string dir(argv[2]);
 
+  // Algorithm C with the given restart policy.
+  auto WithRestarts = [](solver::algorithm::C::Restarts restarts) {
+    auto c = std::make_unique<solver::algorithm::C>();
+    c->SetRestarts(restarts);
+    return c;
+  };
+
   std::map<std::string, std::unique_ptr<solver::Solver>> solvers;
   solvers["A"] = std::make_unique<solver::algorithm::A>();
   solvers["A2"] = std::make_unique<solver::algorithm::A2>();
   solvers["B"] = std::make_unique<solver::algorithm::B>();
   solvers["C"] = std::make_unique<solver::algorithm::C>();
+  solvers["CC"] = std::make_unique<solver::algorithm::CubeAndConquer>();
+  solvers["CG"] = WithRestarts(solver::algorithm::C::Restarts::kGlucose);
+  solvers["CL"] = WithRestarts(solver::algorithm::C::Restarts::kLuby);
+  solvers["CM"] = WithRestarts(solver::algorithm::C::Restarts::kSwitching);
+  auto rephasing = std::make_unique<solver::algorithm::C>();
+  rephasing->SetRephasing(true);
+  solvers["CR"] = std::move(rephasing);
+  solvers["CS"] = WithRestarts(solver::algorithm::C::Restarts::kStable);
   solvers["D"] = std::make_unique<solver::algorithm::D>();
   solvers["I0"] = std::make_unique<solver::algorithm::I0>();
+  solvers["L"] = std::make_unique<solver::algorithm::L>();
+  solvers["PA"] = std::make_unique<solver::algorithm::Parallel>(
+      []() { return std::make_unique<solver::algorithm::A>(); });
+  solvers["PB"] = std::make_unique<solver::algorithm::Parallel>(
+      []() { return std::make_unique<solver::algorithm::B>(); });
+  solvers["PD"] = std::make_unique<solver::algorithm::Parallel>(
+      []() { return std::make_unique<solver::algorithm::D>(); });
+  solvers["PC"] = std::make_unique<solver::algorithm::Portfolio>();
+  solvers["W"] = std::make_unique<solver::algorithm::W>();
+  solvers["WP"] = std::make_unique<solver::algorithm::W>(
+      solver::algorithm::W::Mode::kProbSAT);
 
   if (solvers.count(solverID) == 0) {
     std::cout << "unknown algorithm: " << solverID << std::endl;
@@ -43,11 +71,18 @@ int main(int argc, char *argv[]) {
   double minTime = std::numeric_limits<double>::max();
   double maxTime = std::numeric_limits<double>::min();
   for (const auto &e : fs::recursive_directory_iterator(dir)) {
-    if (!e.is_regular_file() || e.path().extension() != ".cnf") {
+    // Compressed DIMACS files are recognized by their inner extension.
+    const auto ext = e.path().extension();
+    const bool binary = ext == ".kcnf";
+    const bool compressed = ext == ".gz" || ext == ".xz" || ext == ".bz2";
+    if (!e.is_regular_file() ||
+        (ext != ".cnf" && !binary &&
+         !(compressed && e.path().stem().extension() == ".cnf"))) {
       continue;
     }
     solver.Reset();
-    auto err = solver::encoder::FromDimacsFile(solver, e.path());
+    auto err = binary ? solver::encoder::FromBinaryFile(solver, e.path())
+                      : solver::encoder::FromDimacsFile(solver, e.path());
     if (!err.empty()) {
       std::cerr << "reading instance: " << err << std::endl;
       return 1;
@@ -0,0 +1,67 @@
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "solver/algorithm/nop.h"
+#include "solver/encoder/binary.h"
+#include "solver/encoder/dimacs.h"
+#include "util/log.h"
+
+namespace fs = std::filesystem;
+
+// Extension of binary CNF files. Any other extension is written as DIMACS.
+constexpr char kBinaryExt[] = ".kcnf";
+
+int main(int argc, char *argv[]) {
+  util::InitLogging();
+
+  if (argc != 3) {
+    std::cout << "usage: convert <input> <output>" << std::endl;
+    std::cout << "Converts between DIMACS and binary CNF files. The format of "
+                 "the output is binary if its extension is "
+              << kBinaryExt << ", and DIMACS otherwise." << std::endl;
+    return 0;
+  }
+
+  fs::path in(argv[1]);
+  fs::path out(argv[2]);
+  solver::algorithm::Nop solver;
+
+  {
+    const bool binary = solver::encoder::IsBinaryFile(in);
+    COMMENT << "reading instance from " << (binary ? "binary" : "DIMACS")
+            << " file: " << in.string();
+    auto start = std::chrono::system_clock::now();
+    auto err = binary ? solver::encoder::FromBinaryFile(solver, in)
+                      : solver::encoder::FromDimacsFile(solver, in);
+    if (!err.empty()) {
+      std::cerr << "error while reading instance: " << err << std::endl;
+      return 1;
+    }
+    std::chrono::duration<double> diff =
+        std::chrono::system_clock::now() - start;
+    COMMENT << "instance read in " << std::fixed << std::setprecision(3)
+            << diff.count() << " secs";
+  }
+
+  {
+    const bool binary = out.extension() == kBinaryExt;
+    COMMENT << "writing instance to " << (binary ? "binary" : "DIMACS")
+            << " file: " << out.string();
+    auto start = std::chrono::system_clock::now();
+    auto err = binary ? solver::encoder::ToBinaryFile(solver, out)
+                      : solver::encoder::ToDimacsFile(solver, out);
+    if (!err.empty()) {
+      std::cerr << "error while writing instance: " << err << std::endl;
+      return 1;
+    }
+    std::chrono::duration<double> diff =
+        std::chrono::system_clock::now() - start;
+    COMMENT << "instance written in " << std::fixed << std::setprecision(3)
+            << diff.count() << " secs";
+  }
+
+  return 0;
+}
@@ -0,0 +1,144 @@
+#include "ipasir/ipasir.h"
+
+#include <cstdlib>
+#include <vector>
+
+#include "solver/algorithm/algorithm.h"
+#include "util/log.h"
+
+#define IPASIR_API extern "C" __attribute__((visibility("default")))
+
+namespace {
+
+using solver::Lit;
+
+// An IPASIR solver on top of the default algorithm.
+//
+// Variables are created on first use, in order, so that IPASIR variable x is
+// always solver variable x. Literals of the clause being added and the
+// assumptions are collected in buffers that are reused across calls.
+class Instance {
+public:
+  void Add(int lit) {
+    if (lit == 0) {
+      solver.AddClause(clause);
+      clause.clear();
+    } else {
+      clause.push_back(ToLit(lit));
+    }
+    state = kInput;
+  }
+
+  void Assume(int lit) {
+    assumptions.push_back(ToLit(lit));
+    state = kInput;
+  }
+
+  int Solve() {
+    auto [res, sol] = solver.Solve(assumptions);
+    assumptions.clear();
+    switch (res) {
+    case solver::Result::kSAT:
+      model.assign(solver.NumVars() + 1, 0);
+      for (const auto &lit : sol) {
+        model[lit.VID()] = lit.IsPos() ? 1 : -1;
+      }
+      state = kSAT;
+      return 10;
+    case solver::Result::kUNSAT:
+      failed.assign(2 * solver.NumVars() + 2, false);
+      for (const auto &lit : solver.Failed()) {
+        failed[lit.ID()] = true;
+      }
+      state = kUNSAT;
+      return 20;
+    default:
+      state = kInput;
+      return 0;
+    }
+  }
+
+  int Val(int lit) const {
+    CHECK(state == kSAT) << "ipasir_val is only valid in the SAT state";
+    const int x = std::abs(lit);
+    if (x >= static_cast<int>(model.size()) || model[x] == 0) {
+      return 0;
+    }
+    return (lit > 0) == (model[x] > 0) ? lit : -lit;
+  }
+
+  int Failed(int lit) const {
+    CHECK(state == kUNSAT) << "ipasir_failed is only valid in the UNSAT state";
+    const int x = std::abs(lit);
+    if (x > solver.NumVars()) {
+      return 0;
+    }
+    return failed[2 * x + (lit < 0)] ? 1 : 0;
+  }
+
+  void SetTerminate(void *data, int (*terminate)(void *)) {
+    if (terminate == nullptr) {
+      solver.SetTerminate(nullptr);
+    } else {
+      solver.SetTerminate([=]() { return terminate(data) != 0; });
+    }
+  }
+
+private:
+  enum State { kInput, kSAT, kUNSAT };
+
+  solver::algorithm::Default solver;
+  State state = kInput;
+  std::vector<Lit> clause;
+  std::vector<Lit> assumptions;
+  std::vector<int> model;
+  std::vector<bool> failed;
+
+  Lit ToLit(int lit) {
+    const int x = std::abs(lit);
+    while (solver.NumVars() < x) {
+      solver.NewVar();
+    }
+    return Lit(2 * x + (lit < 0));
+  }
+};
+
+} // namespace
+
+IPASIR_API const char *ipasir_signature() { return "kaktusat-0.1"; }
+
+IPASIR_API void *ipasir_init() { return new Instance(); }
+
+IPASIR_API void ipasir_release(void *solver) {
+  delete static_cast<Instance *>(solver);
+}
+
+IPASIR_API void ipasir_add(void *solver, int lit) {
+  static_cast<Instance *>(solver)->Add(lit);
+}
+
+IPASIR_API void ipasir_assume(void *solver, int lit) {
+  static_cast<Instance *>(solver)->Assume(lit);
+}
+
+IPASIR_API int ipasir_solve(void *solver) {
+  return static_cast<Instance *>(solver)->Solve();
+}
+
+IPASIR_API int ipasir_val(void *solver, int lit) {
+  return static_cast<Instance *>(solver)->Val(lit);
+}
+
+IPASIR_API int ipasir_failed(void *solver, int lit) {
+  return static_cast<Instance *>(solver)->Failed(lit);
+}
+
+IPASIR_API void ipasir_set_terminate(void *solver, void *data,
+                                     int (*terminate)(void *data)) {
+  static_cast<Instance *>(solver)->SetTerminate(data, terminate);
+}
+
+// Learned clauses are not exported, which IPASIR allows: the callback is
+// simply never called.
+IPASIR_API void ipasir_set_learn(void *, void *, int, void (*)(void *, int *)) {
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+/*
+ * IPASIR, the Reentrant Incremental SAT solver API.
+ *
+ * Literals are non-zero integers as in the DIMACS format, i.e. variable x is
+ * represented by x and its negation by -x. A solver starts in the INPUT state,
+ * moves to SAT or UNSAT after a call to ipasir_solve and returns to INPUT after
+ * a call to ipasir_add or ipasir_assume.
+ *
+ * @see: Balyo, T., Biere, A., Iser, M., Sinz, C.: SAT Race 2015. Artificial
+ *       Intelligence. 241, 45–65 (2016)
+ *       https://doi.org/10.1016/j.artint.2016.08.007
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Name and version of the solver.
+const char *ipasir_signature();
+
+// Creates a new solver instance in the INPUT state.
+void *ipasir_init();
+
+// Destroys a solver instance, releasing all its resources.
+void ipasir_release(void *solver);
+
+// Adds literal lit to the clause being built, or finishes it if lit is 0.
+void ipasir_add(void *solver, int lit);
+
+// Assumes literal lit to be true in the next call to ipasir_solve only.
+void ipasir_assume(void *solver, int lit);
+
+// Solves the instance under the current assumptions. Returns 10 if it's
+// satisfiable, 20 if it's unsatisfiable and 0 if it was interrupted.
+int ipasir_solve(void *solver);
+
+// Returns lit if it's true in the satisfying assignment found, -lit if it's
+// false and 0 if it can take either value. Valid in the SAT state only.
+int ipasir_val(void *solver, int lit);
+
+// Returns 1 if assumption lit was used to prove unsatisfiability, or 0
+// otherwise. Valid in the UNSAT state only.
+int ipasir_failed(void *solver, int lit);
+
+// Sets a callback polled during ipasir_solve, which is interrupted as soon as
+// the callback returns a non-zero value.
+void ipasir_set_terminate(void *solver, void *data,
+                          int (*terminate)(void *data));
+
+// Sets a callback receiving learned clauses of up to max_length literals.
+void ipasir_set_learn(void *solver, void *data, int max_length,
+                      void (*learn)(void *data, int *clause));
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,4 +1,6 @@
 #include <chrono>
+#include <csignal>
+#include <filesystem>
 #include <iomanip>
 #include <iostream>
 #include <map>
@@ -7,32 +9,79 @@
 #include <utility>
 
 #include "solver/algorithm/algorithm.h"
+#include "solver/encoder/binary.h"
 #include "solver/encoder/dimacs.h"
+#include "solver/encoder/model_writer.h"
 #include "util/log.h"
 
 constexpr size_t kValuesPerLine = 10;
 
+// Solver being run, interrupted on SIGINT and SIGTERM so that the results
+// gathered so far are still reported.
+static solver::Solver *running = nullptr;
+
+static void Interrupt(int) {
+  if (running != nullptr) {
+    running->Terminate();
+  }
+}
+
 int main(int argc, char *argv[]) {
   util::InitLogging();
 
-  if (argc != 3) {
-    std::cout << "usage: main <algorithm> <instance.cnf>" << std::endl;
+  if (argc != 3 && argc != 4) {
+    std::cout << "usage: main <algorithm> <instance.cnf[.gz|.xz|.bz2]> "
+                 "[models.txt]"
+              << std::endl;
+    std::cout << "  every satisfying assignment is written to models.txt, if "
+                 "given"
+              << std::endl;
+    std::cout << "  with algorithm CC, cubes are written instead to a file "
+                 "ending in .icnf"
+              << std::endl;
     return 0;
   }
 
   std::string solverID(argv[1]);
   std::string path(argv[2]);
 
+  // Algorithm C with the given restart policy.
+  auto WithRestarts = [](solver::algorithm::C::Restarts restarts) {
+    auto c = std::make_unique<solver::algorithm::C>();
+    c->SetRestarts(restarts);
+    return c;
+  };
+
   std::map<std::string, std::unique_ptr<solver::Solver>> solvers;
   solvers["A"] = std::make_unique<solver::algorithm::A>();
   solvers["A2"] = std::make_unique<solver::algorithm::A2>();
   solvers["B"] = std::make_unique<solver::algorithm::B>();
   solvers["C"] = std::make_unique<solver::algorithm::C>();
+  solvers["CC"] = std::make_unique<solver::algorithm::CubeAndConquer>();
+  solvers["CG"] = WithRestarts(solver::algorithm::C::Restarts::kGlucose);
+  solvers["CL"] = WithRestarts(solver::algorithm::C::Restarts::kLuby);
+  solvers["CM"] = WithRestarts(solver::algorithm::C::Restarts::kSwitching);
+  auto rephasing = std::make_unique<solver::algorithm::C>();
+  rephasing->SetRephasing(true);
+  solvers["CR"] = std::move(rephasing);
+  solvers["CS"] = WithRestarts(solver::algorithm::C::Restarts::kStable);
   solvers["D"] = std::make_unique<solver::algorithm::D>();
   solvers["I0"] = std::make_unique<solver::algorithm::I0>();
+  solvers["L"] = std::make_unique<solver::algorithm::L>();
+  solvers["PA"] = std::make_unique<solver::algorithm::Parallel>(
+      []() { return std::make_unique<solver::algorithm::A>(); });
+  solvers["PB"] = std::make_unique<solver::algorithm::Parallel>(
+      []() { return std::make_unique<solver::algorithm::B>(); });
+  solvers["PD"] = std::make_unique<solver::algorithm::Parallel>(
+      []() { return std::make_unique<solver::algorithm::D>(); });
+  solvers["PC"] = std::make_unique<solver::algorithm::Portfolio>();
+  solvers["W"] = std::make_unique<solver::algorithm::W>();
+  solvers["WP"] = std::make_unique<solver::algorithm::W>(
+      solver::algorithm::W::Mode::kProbSAT);
   solvers["NOP"] = std::make_unique<solver::algorithm::Nop>();
   solvers["Z"] = std::make_unique<solver::algorithm::Z>();
   solvers["?"] = std::make_unique<solver::algorithm::Analyze>();
+  solvers["#"] = std::make_unique<solver::algorithm::Counter>();
 
   if (solvers.count(solverID) == 0) {
     std::cerr << "unknown algorithm: " << solverID;
@@ -42,9 +91,12 @@ int main(int argc, char *argv[]) {
   auto &solver = *solvers[solverID];
 
   {
-    COMMENT << "reading instance from DIMACS file: " << path;
+    const bool binary = solver::encoder::IsBinaryFile(path);
+    COMMENT << "reading instance from " << (binary ? "binary" : "DIMACS")
+            << " file: " << path;
     auto start = std::chrono::system_clock::now();
-    auto err = solver::encoder::FromDimacsFile(solver, path);
+    auto err = binary ? solver::encoder::FromBinaryFile(solver, path)
+                      : solver::encoder::FromDimacsFile(solver, path);
     if (!err.empty()) {
       LOG << "error while reading instance: " << err;
       return 1;
@@ -55,8 +107,63 @@ int main(int argc, char *argv[]) {
             << diff.count() << " secs";
   }
 
+  if (argc == 4 && std::filesystem::path(argv[3]).extension() == ".icnf") {
+    // Cubes are written for other solvers to conquer, rather than solved.
+    auto *cuber = dynamic_cast<solver::algorithm::CubeAndConquer *>(&solver);
+    if (cuber == nullptr) {
+      LOG << "cubes are only split by algorithm CC";
+      return 1;
+    }
+    COMMENT << "splitting the instance into cubes with Algorithm " << solverID;
+    const auto cubes = cuber->Split();
+    if (auto err = solver::encoder::ToICNFFile(solver, cubes, argv[3]);
+        !err.empty()) {
+      LOG << "error while writing cubes: " << err;
+      return 1;
+    }
+    COMMENT << "wrote " << cubes.size() << " cubes to " << argv[3];
+    if (cubes.empty()) {
+      RESULT << "UNSATISFIABLE";
+    }
+    COMMENT << "done";
+    return 0;
+  }
+
+  if (argc == 4) {
+    // Models are written as they're found, rather than kept until the end.
+    solver::encoder::ModelWriter writer;
+    if (auto err = writer.Open(argv[3]); !err.empty()) {
+      LOG << "error while writing models: " << err;
+      return 1;
+    }
+    COMMENT << "listing all satisfying assignments with Algorithm " << solverID;
+    running = &solver;
+    std::signal(SIGINT, Interrupt);
+    std::signal(SIGTERM, Interrupt);
+    auto start = std::chrono::system_clock::now();
+    auto res = solver.SolveAll(
+        [&](const solver::Assignment &sol) { return writer.Write(sol); });
+    auto end = std::chrono::system_clock::now();
+    std::chrono::duration<double> diff = end - start;
+    if (auto err = writer.Close(); !err.empty()) {
+      LOG << "error while writing models: " << err;
+      return 1;
+    }
+    COMMENT << "wrote " << writer.Count() << " models to " << argv[3]
+            << " in " << std::fixed << std::setprecision(3) << diff.count()
+            << " secs";
+    RESULT << (res == solver::Result::kSAT     ? "SATISFIABLE"
+               : res == solver::Result::kUNSAT ? "UNSATISFIABLE"
+                                               : "UNKNOWN");
+    COMMENT << "done";
+    return 0;
+  }
+
   {
     COMMENT << "solving with Algorithm " << solverID;
+    running = &solver;
+    std::signal(SIGINT, Interrupt);
+    std::signal(SIGTERM, Interrupt);
     auto start = std::chrono::system_clock::now();
     auto [res, sol] = solver.Solve();
     auto end = std::chrono::system_clock::now();
@@ -88,10 +195,14 @@ int main(int argc, char *argv[]) {
       RESULT << "UNSATISFIABLE";
       break;
 
-    case solver::Result::kUnknown:
+    case solver::Result::kUnknown: {
+      const auto &usage = solver.GetUsage();
+      COMMENT << "gave up after conflicts=" << usage.conflicts
+              << " propagations=" << usage.propagations;
       RESULT << "UNKNOWN";
       break;
     }
+    }
   }
 
   COMMENT << "done";
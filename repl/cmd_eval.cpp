@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <cassert>
 #include <curses.h>
+#include <functional>
 #include <sstream>
 
 #include "repl/context.h"
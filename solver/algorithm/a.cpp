@@ -9,21 +9,32 @@ namespace solver {
 namespace algorithm {
 
 std::pair<Result, Assignment> A::Solve() {
-  std::vector<Assignment> sol;
-  auto res = SolveInternal(sol, false);
-  if (res == Result::kSAT) {
-    return {Result::kSAT, sol.back()};
-  }
-  return {res, {}};
+  Assignment sol;
+  auto res = SolveInternal(
+      [&](const Assignment &model) {
+        sol = model;
+        return false;
+      },
+      false);
+  return {res, sol};
 }
 
 std::pair<Result, std::vector<Assignment>> A::SolveAll() {
-  std::vector<Assignment> sol;
-  auto res = SolveInternal(sol, true);
-  return {res, sol};
+  std::vector<Assignment> sols;
+  auto res = SolveInternal(
+      [&](const Assignment &model) {
+        sols.push_back(model);
+        return true;
+      },
+      true);
+  return {res, sols};
 }
 
-Result A::SolveInternal(std::vector<Assignment> &solutions, bool all) {
+Result A::SolveAll(const ModelFn &fn) { return SolveInternal(fn, true); }
+
+// Builds the cell arrays from the clauses, sorting the literals of each clause
+// in place.
+void A::Compile() {
   const int n = NumVars();
 
   std::vector<int> L(2 * n + 2, 0);
@@ -48,10 +59,11 @@ Result A::SolveInternal(std::vector<Assignment> &solutions, bool all) {
   // Build initial structure.
   int p = 2 * n + 2;
   for (int i = NumClauses() - 1; i >= 0; --i) {
-    std::sort(clauses_[i].rbegin(), clauses_[i].rend());
+    auto c = clauses_[clauses_.Refs()[i]];
+    std::sort(c.rbegin(), c.rend());
     START[i + 1] = p;
-    SIZE[i + 1] = static_cast<int>(clauses_[i].size());
-    for (Lit ll : clauses_[i]) {
+    SIZE[i + 1] = static_cast<int>(c.size());
+    for (Lit ll : c) {
       const int l = ll.ID();
       L.push_back(l);
       F.push_back(F[l] == 0 ? l : F[l]);
@@ -64,6 +76,30 @@ Result A::SolveInternal(std::vector<Assignment> &solutions, bool all) {
     }
   }
 
+  layout_.L = std::move(L);
+  layout_.F = std::move(F);
+  layout_.B = std::move(B);
+  layout_.C = std::move(C);
+  layout_.START = std::move(START);
+  layout_.SIZE = std::move(SIZE);
+  layout_.revision = Revision();
+}
+
+Result A::SolveInternal(const ModelFn &fn, bool all) {
+  StartSearch();
+  const int n = NumVars();
+
+  if (layout_.revision != Revision()) {
+    Compile();
+  }
+  // The search modifies the links, counts and sizes, so it works on copies.
+  const std::vector<int> &L = layout_.L;
+  std::vector<int> F = layout_.F;
+  std::vector<int> B = layout_.B;
+  std::vector<int> C = layout_.C;
+  const std::vector<int> &START = layout_.START;
+  std::vector<int> SIZE = layout_.SIZE;
+
   // Move codes:
   //   m[j] = 0: trying xj, didn't try ~xj yet.
   //   m[j] = 1: trying ~xj, didn't try xj, yet.
@@ -73,22 +109,30 @@ Result A::SolveInternal(std::vector<Assignment> &solutions, bool all) {
   //   m[j] = 5: trying ~xj, and xj doesn't appear.
   std::vector<int> m(n + 1, 0);
 
+  // Satisfying assignment handed to fn.
+  Assignment model;
+
 A1: // Initialize.
 
-  int a = NumClauses(); // number of active clauses.
-  int d = 1;            // depth-plus-one in an implicit search tree.
-  int l;                // chosen literal.
+  int a = NumClauses();  // number of active clauses.
+  int d = 1;             // depth-plus-one in an implicit search tree.
+  int l;                 // chosen literal.
+  int64_t conflicts = 0; // number of dead ends found.
+  bool found = false;    // whether any satisfying assignment was found.
 
 A2: // Choose.
   // If we want to find all satisfying assignments, we don't backtrack early and
   // add literals while no clause is falsified.
   if (all && d == n + 1) {
-    std::vector<Lit> ret;
+    model.clear();
     for (int j = 1; j <= n; ++j) {
       Var x(j);
-      ret.push_back((1 ^ (m[j] & 1)) ? x : ~x);
+      model.push_back((1 ^ (m[j] & 1)) ? x : ~x);
+    }
+    found = true;
+    if (!fn(model)) {
+      return Result::kSAT;
     }
-    solutions.emplace_back(ret);
     goto A6;
   }
 
@@ -108,12 +152,11 @@ A2: // Choose.
   LOG << "A2: choose l=" << ToString(Lit(l)) << " a=" << a;
 
   if (!all && C[l] == a) {
-    std::vector<Lit> ret;
     for (int j = 1; j <= d; ++j) {
       Var x(j);
-      ret.push_back((1 ^ (m[j] & 1)) ? x : ~x);
+      model.push_back((1 ^ (m[j] & 1)) ? x : ~x);
     }
-    solutions.emplace_back(ret);
+    fn(model);
     return Result::kSAT;
   }
 
@@ -156,6 +199,9 @@ A4: // Deactivate l's clauses.
   goto A2;
 
 A5: // Try again.
+  if (Interrupted(++conflicts)) {
+    return Result::kUnknown;
+  }
   if (m[d] < 2) {
     m[d] = 3 - m[d];
     l = 2 * d + (m[d] & 1);
@@ -165,7 +211,7 @@ A5: // Try again.
 
 A6: // Backtrack.
   if (d == 1) {
-    return solutions.empty() ? Result::kUNSAT : Result::kSAT;
+    return found ? Result::kSAT : Result::kUNSAT;
   } else {
     --d;
     l = 2 * d + (m[d] & 1);
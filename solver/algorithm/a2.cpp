@@ -8,7 +8,9 @@
 namespace solver {
 namespace algorithm {
 
-std::pair<Result, Assignment> A2::Solve() {
+// Builds the cell arrays from the clauses, sorting the literals of each clause
+// in place.
+void A2::Compile() {
   const int n = NumVars();
 
   std::vector<int> L(2 * n + 2, 0);
@@ -30,10 +32,11 @@ std::pair<Result, Assignment> A2::Solve() {
   // Build initial structure.
   int p = 2 * n + 2;
   for (int i = NumClauses() - 1; i >= 0; --i) {
-    std::sort(clauses_[i].rbegin(), clauses_[i].rend());
+    auto c = clauses_[clauses_.Refs()[i]];
+    std::sort(c.rbegin(), c.rend());
     START[i + 1] = p;
-    SIZE[i + 1] = static_cast<int>(clauses_[i].size());
-    for (Lit ll : clauses_[i]) {
+    SIZE[i + 1] = static_cast<int>(c.size());
+    for (Lit ll : c) {
       const int l = ll.ID();
       L.push_back(l);
       F.push_back(F[l] == 0 ? l : F[l]);
@@ -44,6 +47,28 @@ std::pair<Result, Assignment> A2::Solve() {
     }
   }
 
+  layout_.L = std::move(L);
+  layout_.F = std::move(F);
+  layout_.C = std::move(C);
+  layout_.START = std::move(START);
+  layout_.SIZE = std::move(SIZE);
+  layout_.revision = Revision();
+}
+
+std::pair<Result, Assignment> A2::Solve() {
+  StartSearch();
+  const int n = NumVars();
+
+  if (layout_.revision != Revision()) {
+    Compile();
+  }
+  // The search modifies the counts and sizes, so it works on copies.
+  const std::vector<int> &L = layout_.L;
+  const std::vector<int> &F = layout_.F;
+  std::vector<int> C = layout_.C;
+  const std::vector<int> &START = layout_.START;
+  std::vector<int> SIZE = layout_.SIZE;
+
   // Move codes:
   //   m[j] = 0: trying xj, didn't try ~xj yet.
   //   m[j] = 1: trying ~xj, didn't try xj, yet.
@@ -59,6 +84,7 @@ A1: // Initialize.
   int d = 1;             // depth-plus-one in an implicit search tree.
   int l;                 // chosen literal.
   bool makesClauseEmpty; // whether selecting l makes a clause empty.
+  int64_t conflicts = 0;  // number of dead ends found.
 
   auto LastLiteral = [&](int j) {
     CHECK(1 <= j && j <= NumClauses()) << "clause index out of bounds: " << j;
@@ -125,6 +151,9 @@ A4: // Deactivate l's clauses.
   goto A2;
 
 A5: // Try again.
+  if (Interrupted(++conflicts)) {
+    return {Result::kUnknown, {}};
+  }
   if (m[d] < 2) {
     m[d] = 3 - m[d];
     l = 2 * d + (m[d] & 1);
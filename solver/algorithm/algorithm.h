@@ -5,9 +5,15 @@
 #include "solver/algorithm/analyze.h"
 #include "solver/algorithm/b.h"
 #include "solver/algorithm/c.h"
+#include "solver/algorithm/counter.h"
+#include "solver/algorithm/cube.h"
 #include "solver/algorithm/d.h"
 #include "solver/algorithm/i0.h"
+#include "solver/algorithm/l.h"
 #include "solver/algorithm/nop.h"
+#include "solver/algorithm/parallel.h"
+#include "solver/algorithm/portfolio.h"
+#include "solver/algorithm/w.h"
 #include "solver/algorithm/z.h"
 
 namespace solver {
@@ -2,7 +2,6 @@
 
 #include <iomanip>
 #include <map>
-#include <set>
 
 #include "util/log.h"
 
@@ -10,18 +9,12 @@ namespace solver {
 namespace algorithm {
 
 std::pair<Result, Assignment> Analyze::Solve() {
-  std::set<Lit> litSeen;
-  std::set<Var> varSeen;
   std::map<int, int> clauseLenCnt;
   std::vector<std::pair<int, std::vector<Lit>>> repeated;
   std::vector<std::pair<int, std::vector<Lit>>> tautologies;
   int clauseIndex = 1;
-  for (const auto &clause : clauses_) {
+  for (const auto clause : clauses_) {
     clauseLenCnt[clause.size()]++;
-    for (const auto &l : clause) {
-      varSeen.insert(l.V());
-      litSeen.insert(l);
-    }
     bool hasRepeated = false;
     bool isTautological = false;
     for (size_t i = 0; i < clause.size(); ++i) {
@@ -35,10 +28,12 @@ std::pair<Result, Assignment> Analyze::Solve() {
       }
     }
     if (hasRepeated) {
-      repeated.emplace_back(clauseIndex, clause);
+      repeated.emplace_back(clauseIndex,
+                            Clause(clause.begin(), clause.end()));
     }
     if (isTautological) {
-      tautologies.emplace_back(clauseIndex, clause);
+      tautologies.emplace_back(clauseIndex,
+                               Clause(clause.begin(), clause.end()));
     }
     ++clauseIndex;
   }
@@ -49,11 +44,14 @@ std::pair<Result, Assignment> Analyze::Solve() {
       << static_cast<double>(NumClauses()) / NumVars();
 
   LOG << "Pure literals: ";
+  const auto &occ = Occurrences();
   for (int i = 1; i <= NumVars(); ++i) {
     Var x(i);
-    if (litSeen.count(x) && !litSeen.count(~x)) {
+    const size_t pos = occ.Count(Lit(x).ID());
+    const size_t neg = occ.Count((~x).ID());
+    if (pos > 0 && neg == 0) {
       LOG << ToString(x) << ' ';
-    } else if (!litSeen.count(x) && litSeen.count(~x)) {
+    } else if (pos == 0 && neg > 0) {
       LOG << ToString(~x) << ' ';
     }
   }
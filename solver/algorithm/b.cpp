@@ -9,21 +9,31 @@ namespace solver {
 namespace algorithm {
 
 std::pair<Result, Assignment> B::Solve() {
-  std::vector<Assignment> sol;
-  auto res = SolveInternal(sol, false);
-  if (res == Result::kSAT) {
-    return {Result::kSAT, sol.back()};
-  }
-  return {res, {}};
+  Assignment sol;
+  auto res = SolveInternal(
+      [&](const Assignment &model) {
+        sol = model;
+        return false;
+      },
+      false);
+  return {res, sol};
 }
 
 std::pair<Result, std::vector<Assignment>> B::SolveAll() {
-  std::vector<Assignment> sol;
-  auto res = SolveInternal(sol, true);
-  return {res, sol};
+  std::vector<Assignment> sols;
+  auto res = SolveInternal(
+      [&](const Assignment &model) {
+        sols.push_back(model);
+        return true;
+      },
+      true);
+  return {res, sols};
 }
 
-Result B::SolveInternal(std::vector<Assignment> &solutions, bool all) {
+Result B::SolveAll(const ModelFn &fn) { return SolveInternal(fn, true); }
+
+// Builds the cells and the initial watch lists from the clauses.
+void B::Compile() {
   // L[i]     = i-th cell's literal.
   // W[l]     = first clause watching literal l or 0 if none.
   // START[j] = first cell of clause j
@@ -37,7 +47,7 @@ Result B::SolveInternal(std::vector<Assignment> &solutions, bool all) {
   // Literals of clause j are in the cells START[j] to START[j-1]-1.
   for (int j = NumClauses(); j >= 1; --j) {
     START[j] = L.size();
-    for (auto l : clauses_[j - 1]) {
+    for (auto l : clauses_[clauses_.Refs()[j - 1]]) {
       L.push_back(l.ID());
     }
     int l = L[START[j]]; // this clause's watchee.
@@ -46,6 +56,24 @@ Result B::SolveInternal(std::vector<Assignment> &solutions, bool all) {
   }
   START[0] = L.size();
 
+  layout_.L = std::move(L);
+  layout_.W = std::move(W);
+  layout_.START = std::move(START);
+  layout_.LINK = std::move(LINK);
+  layout_.revision = Revision();
+}
+
+Result B::SolveInternal(const ModelFn &fn, bool all) {
+  StartSearch();
+  if (layout_.revision != Revision()) {
+    Compile();
+  }
+  // The search moves watched literals around, so it works on copies.
+  std::vector<int> L = layout_.L;
+  std::vector<int> W = layout_.W;
+  const std::vector<int> &START = layout_.START;
+  std::vector<int> LINK = layout_.LINK;
+
   // Move codes:
   //   m[j] = 0: trying xj, didn't try ~xj yet.
   //   m[j] = 1: trying ~xj, didn't try xj, yet.
@@ -53,23 +81,27 @@ Result B::SolveInternal(std::vector<Assignment> &solutions, bool all) {
   //   m[j] = 3: trying ~xj, after xj failed.
   std::vector<int> m(NumVars() + 1, 0);
 
+  // Satisfying assignment handed to fn.
+  Assignment model;
+
 B1: // Initialize.
   int d = 1;
   int l;
+  int64_t conflicts = 0; // number of dead ends found.
+  bool found = false;    // whether any satisfying assignment was found.
 
 B2: // Rejoice or choose.
   if (d > NumVars()) {
-    std::vector<Lit> ret;
+    model.clear();
     for (int j = 1; j <= NumVars(); ++j) {
       Var x(j);
-      ret.push_back((1 ^ (m[j] & 1)) ? x : ~x);
+      model.push_back((1 ^ (m[j] & 1)) ? x : ~x);
     }
-    solutions.emplace_back(ret);
-    if (all) {
-      goto B6;
-    } else {
+    found = true;
+    if (!fn(model) || !all) {
       return Result::kSAT;
     }
+    goto B6;
   }
   // Choose ~l if W[l] is empty or W[~l] is not empty.
   m[d] = (W[2 * d] == 0 || W[2 * d + 1] != 0);
@@ -113,6 +145,9 @@ B4: // Advance.
   goto B2;
 
 B5: // Try again.
+  if (Interrupted(++conflicts)) {
+    return Result::kUnknown;
+  }
   if (m[d] < 2) {
     m[d] = 3 - m[d];
     l = 2 * d + (m[d] & 1);
@@ -122,7 +157,7 @@ B5: // Try again.
 
 B6: // Backtrack.
   if (d == 1) {
-    return solutions.empty() ? Result::kUNSAT : Result::kSAT;
+    return found ? Result::kSAT : Result::kUNSAT;
   }
   --d;
   LOG << "B6: backtrack with d=" << d;
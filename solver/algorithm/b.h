@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -17,10 +19,25 @@ public:
 
   std::pair<Result, Assignment> Solve() override;
   std::pair<Result, std::vector<Assignment>> SolveAll() override;
+  Result SolveAll(const ModelFn &) override;
   std::string ID() const override { return "B"; }
 
 private:
-  Result SolveInternal(std::vector<Assignment> &, bool);
+  // Arrays built from the clauses by Compile. The search works on copies of
+  // those it modifies, so they're reused by later calls until the instance
+  // changes.
+  struct Layout {
+    uint64_t revision = std::numeric_limits<uint64_t>::max();
+    std::vector<int> L;
+    std::vector<int> W;
+    std::vector<int> START;
+    std::vector<int> LINK;
+  };
+
+  Layout layout_;
+
+  Result SolveInternal(const ModelFn &, bool);
+  void Compile();
 };
 
 } // namespace algorithm
@@ -1,7 +1,9 @@
 #include "solver/algorithm/c.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <functional>
 #include <iomanip>
 #include <limits>
 #include <numeric>
@@ -9,144 +11,174 @@
 #include <sstream>
 #include <type_traits>
 
+#include "solver/local_search.h"
 #include "util/log.h"
 
 namespace solver {
 namespace algorithm {
 
-struct Stats {
-  int64_t decisions = 0;
-  int64_t conflicts = 0;
-  int64_t propagations = 0;
-  int64_t restarts = 0;
-  int64_t learnedClauses = 0;
-  int64_t clauseLength = 0;
-  int64_t purged = 0;
+// A clause watching a literal, along with another literal of the same clause
+// acting as blocker: while the blocker is true, the clause is satisfied and can
+// be skipped without reading the clause itself.
+struct Watcher {
+  CRef cref;
+  Lit blocker;
+};
 
-  std::string ToString() const {
-    std::stringstream out;
-    out << "decisions=" << decisions << " conflicts=" << conflicts
-        << " propagations=" << propagations << " restarts=" << restarts
-        << " learned=" << learnedClauses << " purged=" << purged
-        << std::setprecision(1) << std::fixed << " avgClauseLen="
-        << static_cast<double>(clauseLength) / learnedClauses;
-    return out.str();
-  }
+// A ternary clause watching a literal, along with its two other literals.
+struct TernaryWatcher {
+  Lit a;
+  Lit b;
+  CRef cref;
 };
 
 // Watch lists for watching 2 literals per clause.
+//
+// Binary and ternary clauses are special-cased so that propagating them never
+// reads clause memory: a binary clause (u ∨ v) is kept as the implications
+// ¬u → v and ¬v → u, and a ternary clause is watched on all of its literals
+// with the other two stored alongside.
 class WatchList {
 public:
-  // Iterator for iterating the watch list of a specific literal.
+  // Iterator for iterating the watch list of a specific literal. Clauses that
+  // stop watching the literal are compacted out of the list as the iterator
+  // advances, and the list is finalized when the iterator is destroyed.
   class Iterator {
   public:
-    Iterator(const std::vector<Clause> &clauses, int l, std::vector<int> &w,
-             std::vector<std::array<int, 2>> &link)
-        : clauses(clauses), l(l), w(w), link(link) {
-      cur = w[l];
-      ptr = &w[l];
-    }
+    Iterator(ClauseArena &clauses, std::vector<std::vector<Watcher>> &w, int l)
+        : clauses(clauses), w(w), ws(w[l]), i(0), j(0) {}
+
+    ~Iterator() { ws.erase(ws.begin() + j, ws.begin() + i); }
+
+    // Reference of the current clause watching l.
+    CRef operator*() const { return ws[i].cref; }
+
+    // Blocker literal of the current clause watching l.
+    Lit Blocker() const { return ws[i].blocker; }
 
-    // Index of the current clause watching l.
-    const int operator*() const { return cur; }
+    // Replaces the blocker literal of the current clause watching l.
+    void SetBlocker(Lit blocker) { ws[i].blocker = blocker; }
 
     // Checks whether there are more clauses watching l.
-    operator bool() const { return cur != -1; }
+    operator bool() const { return i < ws.size(); }
 
     // Advance to next clause watching l.
     Iterator &operator++() {
-      CHECK(0 <= cur && cur < static_cast<int>(link.size()))
-          << "current clause is out of range: cur=" << cur;
-      ptr = &link[cur][clauses[cur][0] != l];
-      cur = *ptr;
+      CHECK(i < ws.size()) << "iterator is out of range: i=" << i;
+      ws[j++] = ws[i++];
       return *this;
     }
 
-    // Swaps the first and second watched literal for current clause.
-    void Swap() {
-      CHECK(0 <= cur && cur < static_cast<int>(link.size()))
-          << "current clause is out of range: cur=" << cur;
-      std::swap(link[cur][0], link[cur][1]);
-    }
-
-    // Move current clause's k-th from l's to ll's watch list and advances the
-    // iterator.
+    // Move current clause's k-th watchee (k=0 or k=1) from l's to ll's watch
+    // list and advances the iterator. The other watchee becomes the blocker.
     Iterator &MoveAndAdvance(int k) {
-      CHECK(0 <= cur && cur < static_cast<int>(link.size()))
-          << "current clause is out of range: cur=" << cur;
-      CHECK(0 <= k && k < static_cast<int>(clauses[cur].size()))
-          << "literal is out of range: k=" << k
-          << " size=" << clauses[cur].size();
-      const int ll = clauses[cur][k].ID();
-      *ptr = link[cur][k];
-      link[cur][k] = w[ll];
-      w[ll] = cur;
-      cur = *ptr;
+      CHECK(i < ws.size()) << "iterator is out of range: i=" << i;
+      CHECK(k == 0 || k == 1) << "watchee is out of range: k=" << k;
+      const auto c = clauses[ws[i].cref];
+      w[c[k].ID()].push_back({ws[i].cref, c[1 - k]});
+      ++i;
       return *this;
     }
 
     // Erase current clause from l's watch list and advances the iterator.
     Iterator &Erase() {
-      CHECK(0 <= cur && cur < static_cast<int>(link.size()))
-          << "current clause is out of range: cur=" << cur;
-      *ptr = link[cur][clauses[cur][0] != l];
-      cur = *ptr;
+      CHECK(i < ws.size()) << "iterator is out of range: i=" << i;
+      ++i;
       return *this;
     }
 
   private:
-    const std::vector<Clause> &clauses;
-    const int l;
-    std::vector<int> &w;
-    std::vector<std::array<int, 2>> &link;
-    int cur;
-    int *ptr;
+    ClauseArena &clauses;
+    std::vector<std::vector<Watcher>> &w;
+    std::vector<Watcher> &ws;
+    size_t i;
+    size_t j;
   };
 
-  WatchList(const std::vector<Clause> &clauses, int n)
-      : clauses(clauses), w(2 * n + 2, -1) {}
+  WatchList(ClauseArena &clauses, int n)
+      : clauses(clauses), w(2 * n + 2), bin(2 * n + 2), tern(2 * n + 2) {}
 
   // Rebuilds the watch lists from scratch using the underlying clauses.
   void Rebuild() {
-    std::fill(w.begin(), w.end(), -1);
-    link.resize(clauses.size(), {-1, -1});
-    for (size_t i = 0; i < clauses.size(); ++i) {
-      Watch(i);
+    for (int l = 0; l < static_cast<int>(w.size()); ++l) {
+      w[l].clear();
+      bin[l].clear();
+      tern[l].clear();
+    }
+    for (auto it = clauses.begin(); it != clauses.end(); ++it) {
+      Watch(it.Ref());
     }
   }
 
-  // Watches clause at index k. Unit clauses are ignored.
-  void Watch(int k) {
-    link.resize(clauses.size(), {-1, -1});
-    const Clause &c = clauses[k];
-    if (c.size() == 1) {
+  // Watches clause cr. Unit clauses are ignored.
+  void Watch(CRef cr) {
+    const auto c = clauses[cr];
+    switch (c.size()) {
+    case 1:
+      return;
+    case 2:
+      bin[c[0].ID()].push_back(c[1]);
+      bin[c[1].ID()].push_back(c[0]);
+      return;
+    case 3:
+      tern[c[0].ID()].push_back({c[1], c[2], cr});
+      tern[c[1].ID()].push_back({c[0], c[2], cr});
+      tern[c[2].ID()].push_back({c[0], c[1], cr});
       return;
     }
     for (size_t off = 0; off < 2; ++off) {
-      link[k][off] = w[c[off].ID()];
-      w[c[off].ID()] = k;
+      w[c[off].ID()].push_back({cr, c[1 - off]});
     }
   }
 
-  // Removes the clause with index k from the watch lists.
-  void Forget(int k) {
-    for (int off = 0; off < 2; ++off) {
-      auto it = Iterate(clauses[k][off].ID());
-      while (*it != k) {
-        ++it;
+  // Removes the clause cr from the watch lists.
+  void Forget(CRef cr) {
+    const auto c = clauses[cr];
+    switch (c.size()) {
+    case 1:
+      return;
+    case 2:
+      for (int off = 0; off < 2; ++off) {
+        auto &bs = bin[c[off].ID()];
+        auto it = std::find(bs.begin(), bs.end(), c[1 - off]);
+        CHECK(it != bs.end()) << "forgotten clause must appear in the list";
+        bs.erase(it);
       }
-      CHECK(*it == k) << "forgotten clause must appear in the watch list";
-      it.Erase();
+      return;
+    case 3:
+      for (const auto &lit : c) {
+        auto &ts = tern[lit.ID()];
+        auto it =
+            std::find_if(ts.begin(), ts.end(),
+                         [&](const TernaryWatcher &x) { return x.cref == cr; });
+        CHECK(it != ts.end()) << "forgotten clause must appear in the list";
+        ts.erase(it);
+      }
+      return;
+    }
+    for (int off = 0; off < 2; ++off) {
+      auto &ws = w[c[off].ID()];
+      auto it = std::find_if(ws.begin(), ws.end(),
+                             [&](const Watcher &x) { return x.cref == cr; });
+      CHECK(it != ws.end()) << "forgotten clause must appear in the watch list";
+      ws.erase(it);
     }
   }
 
   // Creates an Iterator for the watch list of literal l.
-  Iterator Iterate(int l) { return Iterator(clauses, l, w, link); }
+  Iterator Iterate(int l) { return Iterator(clauses, w, l); }
+
+  // Literals implied by binary clauses when literal l becomes false.
+  const std::vector<Lit> &Binary(int l) const { return bin[l]; }
+
+  // Ternary clauses containing literal l.
+  const std::vector<TernaryWatcher> &Ternary(int l) const { return tern[l]; }
 
 private:
-  const std::vector<Clause> &clauses;
-  std::vector<int> w;
-  std::vector<std::array<int, 2>> link;
+  ClauseArena &clauses;
+  std::vector<std::vector<Watcher>> w;
+  std::vector<std::vector<Lit>> bin;
+  std::vector<std::vector<TernaryWatcher>> tern;
 };
 
 // A heap for managing activity scores to make branching decisions.
@@ -217,6 +249,22 @@ public:
   // Checks whether variable k is in the heap.
   bool Contains(int k) const { return loc[k] > 0; }
 
+  // Adds variables n+1,...,size to the heap in random order, with no
+  // activity.
+  void Grow(int size, std::mt19937 &rng) {
+    std::vector<int> p(size - n);
+    std::iota(p.begin(), p.end(), n + 1);
+    std::shuffle(p.begin(), p.end(), rng);
+
+    h.resize(size + 1);
+    loc.resize(size + 1, 0);
+    act.resize(size + 1, 0);
+    n = size;
+    for (const int k : p) {
+      Push(k);
+    }
+  }
+
   // Returns the number of variables currently in the heap.
   int Size() const { return size; }
 
@@ -253,7 +301,7 @@ public:
   }
 
 private:
-  const int n;
+  int n;
   int size;
   std::vector<int> h;
   std::vector<int> loc;
@@ -313,29 +361,364 @@ private:
   T v;
 };
 
-std::pair<Result, Assignment> C::Solve() {
+// Exponential moving average, with the bias towards its initial value of zero
+// corrected as in Adam.
+//
+// @see: Biere, A., Fröhlich, A.: Evaluating CDCL Restart Schemes. In:
+//       Pragmatics of SAT 2015 (2015)
+class EMA {
+public:
+  explicit EMA(double alpha) : alpha_(alpha), biased_(0), beta_(1) {}
+
+  void Update(double x) {
+    biased_ += alpha_ * (x - biased_);
+    beta_ *= 1 - alpha_;
+  }
+
+  double Value() const { return beta_ < 1 ? biased_ / (1 - beta_) : 0; }
+
+private:
+  double alpha_;
+  double biased_;
+  // (1 - alpha)^n after n updates.
+  double beta_;
+};
+
+// Learned clause database, keeping learned clauses in three tiers:
+//
+//   core  = clauses with LBD up to kCoreLBD, kept forever.
+//   mid   = clauses with LBD up to kMidLBD, kept while they take part in
+//           conflicts between reductions and demoted to local otherwise.
+//   local = remaining clauses, of which the less active half is dropped on
+//           every reduction unless recently used.
+//
+// Reductions happen every few conflicts, with a slowly growing interval, or
+// earlier if the clause arena grows beyond the memory limit.
+//
+// @see: Audemard, G., Simon, L.: Predicting Learnt Clauses Quality in Modern
+//       SAT Solvers. In: IJCAI 2009. pp. 399–404 (2009)
+// @see: Oh, C.: Between SAT and UNSAT: The Fundamental Difference in CDCL SAT.
+//       In: Theory and Applications of Satisfiability Testing – SAT 2015.
+//       pp. 307–323. Springer International Publishing (2015)
+class LearnedClauses {
+  enum Tier : uint32_t { kCore = 0, kMid = 1, kLocal = 2 };
+
+  static constexpr uint32_t kCoreLBD = 2;
+  static constexpr uint32_t kMidLBD = 6;
+  static constexpr float kDecay = 0.999f;
+  static constexpr float kMaxActivity = 1e20f;
+  static constexpr int64_t kFirstInterval = 2000;
+  static constexpr int64_t kIntervalInc = 300;
+  static constexpr int64_t kMinInterval = 100;
+
+public:
+  LearnedClauses(ClauseArena &clauses)
+      : clauses(clauses), memoryLimit(0), inc(1), interval(kFirstInterval),
+        last(0), next(kFirstInterval) {}
+
+  // Sets the maximum size in bytes of the clause arena, or 0 if unlimited.
+  void SetMemoryLimit(size_t bytes) { memoryLimit = bytes; }
+
+  // Registers the newly learned clause cr with the given LBD.
+  void Add(CRef cr, uint32_t lbd) {
+    auto &h = clauses[cr].Header();
+    h.lbd = lbd;
+    h.tier = TierOf(lbd);
+    h.used = true;
+    h.activity = inc;
+  }
+
+  // Bumps the learned clause cr, which took part in a conflict. Its LBD is
+  // refreshed with computeLBD, possibly promoting it to a better tier.
+  template <typename F> void Bump(CRef cr, F computeLBD) {
+    auto c = clauses[cr];
+    auto &h = c.Header();
+    if (!h.learned) {
+      return;
+    }
+    h.used = true;
+    if (h.tier != kCore) {
+      const uint32_t lbd = computeLBD(c.begin(), c.end());
+      if (lbd < h.lbd) {
+        h.lbd = lbd;
+        h.tier = std::min<uint32_t>(h.tier, TierOf(lbd));
+      }
+    }
+    if (h.tier == kLocal && (h.activity += inc) > kMaxActivity) {
+      for (auto it = clauses.begin(); it != clauses.end(); ++it) {
+        (*it).Header().activity /= kMaxActivity;
+      }
+      inc /= kMaxActivity;
+    }
+  }
+
+  // Decays the activity of every clause, after a conflict.
+  void Decay() { inc /= kDecay; }
+
+  // Checks whether the learned clauses should be reduced after the given
+  // number of conflicts.
+  bool ShouldReduce(int64_t conflicts) const {
+    return conflicts >= next ||
+           (conflicts >= last + kMinInterval && OverLimit());
+  }
+
+  // Drops learned clauses from the arena, never dropping those for which
+  // isLocked holds. Returns the number of dropped clauses.
+  template <typename F> int Reduce(int64_t conflicts, F isLocked) {
+    last = conflicts;
+    next = conflicts + interval;
+    interval += kIntervalInc;
+
+    std::vector<CRef> local;
+    std::vector<CRef> mid;
+    for (auto it = clauses.begin(); it != clauses.end(); ++it) {
+      auto &h = (*it).Header();
+      if (!h.learned || h.tier == kCore) {
+        continue;
+      }
+      if (h.tier == kMid && !h.used) {
+        h.tier = kLocal;
+      }
+      if (!isLocked(it.Ref())) {
+        if (h.tier == kMid) {
+          mid.push_back(it.Ref());
+        } else if (!h.used) {
+          local.push_back(it.Ref());
+        }
+      }
+      h.used = false;
+    }
+
+    // Less active local clauses go first.
+    std::sort(local.begin(), local.end(), [&](CRef lhs, CRef rhs) {
+      return clauses[lhs].Header().activity < clauses[rhs].Header().activity;
+    });
+    int dropped = 0;
+    auto drop = [&](const std::vector<CRef> &crs, size_t count) {
+      for (size_t i = 0; i < count; ++i) {
+        clauses.Free(crs[i]);
+        ++dropped;
+      }
+    };
+    drop(local, local.size() / 2);
+    // If the arena is still too large, sacrifice the rest of local and mid
+    // clauses.
+    if (OverLimit()) {
+      local.erase(local.begin(), local.begin() + local.size() / 2);
+      drop(local, local.size());
+      if (OverLimit()) {
+        drop(mid, mid.size());
+      }
+    }
+    return dropped;
+  }
+
+private:
+  ClauseArena &clauses;
+  size_t memoryLimit;
+  float inc;
+  int64_t interval;
+  int64_t last;
+  int64_t next;
+
+  static uint32_t TierOf(uint32_t lbd) {
+    return lbd <= kCoreLBD ? kCore : lbd <= kMidLBD ? kMid : kLocal;
+  }
+
+  bool OverLimit() const {
+    return memoryLimit > 0 &&
+           (clauses.Words() - clauses.WastedWords()) * sizeof(uint32_t) >
+               memoryLimit;
+  }
+};
+
+// Search state kept between calls to C::Solve.
+//
+//   old[k]     = old value of k, used for phase saving.
+//   initial[k] = initial value of k, drawn once.
+//   heap       = activity heap of the variables.
+//   learned    = learned clause database.
+struct C::State {
+  State(ClauseArena &clauses, uint32_t seed)
+      : rng(seed), heap(0, rng), old(1, 1), initial(1, 1), best(1, 1),
+        learned(clauses) {}
+
+  // Makes room for variables up to n, whose initial phase is given.
+  void Grow(int n, Phase phase) {
+    heap.Grow(n, rng);
+    while (static_cast<int>(old.size()) <= n) {
+      initial.push_back(Initial(phase));
+      old.push_back(initial.back());
+      best.push_back(initial.back());
+    }
+  }
+
+  // Initial phase of a variable.
+  int Initial(Phase phase) {
+    return phase == Phase::kPositive   ? 0
+           : phase == Phase::kNegative ? 1
+                                       : static_cast<int>(rng() & 1);
+  }
+
+  std::mt19937 rng;
+  ActivityHeap<double> heap;
+  std::vector<int> old;
+  std::vector<int> initial;
+  // Phases of the longest trail reached since the last rephasing.
+  std::vector<int> best;
+  // Number of resets of the phases.
+  int64_t rephases = 0;
+  // Propagations when local search last ran.
+  int64_t lastWalk = 0;
+  LearnedClauses learned;
+  Stats stats;
+};
+
+std::string C::Stats::ToString() const {
+  std::stringstream out;
+  out << "decisions=" << decisions << " conflicts=" << conflicts
+      << " propagations=" << propagations << " restarts=" << restarts
+      << " learned=" << learnedClauses << " purged=" << purged
+      << " switches=" << switches << " rephases=" << rephases
+      << " flips=" << flips
+      << std::setprecision(1) << std::fixed << " avgClauseLen="
+      << static_cast<double>(clauseLength) / learnedClauses;
+  return out.str();
+}
+
+C::C()
+    : memoryLimit_(0), backtrack_(false), seeded_(false), seed_(0),
+      phase_(Phase::kNegative), restarts_(Restarts::kFlush),
+      rephase_(false) {}
+
+C::~C() {}
+
+void C::Reset() {
+  Solver::Reset();
+  failed_.clear();
+  state_.reset();
+}
+
+C::Stats C::GetStats() const { return state_ ? state_->stats : Stats(); }
+
+void C::SetSeed(uint32_t seed) {
+  seeded_ = true;
+  seed_ = seed;
+  if (state_) {
+    state_->rng.seed(seed);
+  }
+}
+
+std::pair<Result, Assignment> C::Solve() { return Solve({}); }
+
+std::pair<Result, Assignment> C::Solve(const std::vector<Lit> &assumptions) {
+  return Search(assumptions, nullptr);
+}
+
+std::pair<Result, std::vector<Assignment>> C::SolveAll() {
+  std::vector<Assignment> sols;
+  auto res = SolveAll([&](const Assignment &model) {
+    sols.push_back(model);
+    return true;
+  });
+  return {res, sols};
+}
+
+Result C::SolveAll(const ModelFn &fn) {
+  bool found = false;
+  const ModelFn onModel = [&](const Assignment &model) {
+    found = true;
+    return fn(model);
+  };
+  auto res = Search({}, &onModel).first;
+
+  // Clauses learned while listing models are either blocking clauses or
+  // derived from them, and only held until now.
+  std::vector<CRef> transient;
+  for (auto it = clauses_.begin(); it != clauses_.end(); ++it) {
+    if ((*it).Header().transient) {
+      transient.push_back(it.Ref());
+    }
+  }
+  for (const CRef cr : transient) {
+    clauses_.Free(cr);
+  }
+  clauses_.Compact();
+  // Running out of models after finding some is the normal way to finish.
+  if (res == Result::kUNSAT && found) {
+    return Result::kSAT;
+  }
+  return res;
+}
+
+std::pair<Result, Assignment> C::Search(const std::vector<Lit> &assumptions,
+                                        const ModelFn *onModel) {
   // Flushing/restart parameters.
   constexpr float kPsi = 1.f / 6;
   constexpr float kTheta = 17.f / 16;
+  // Learned clauses per unit of the Luby sequence.
+  constexpr int kLubyUnit = 64;
+  // Learned clauses per unit of the Luby sequence in stable mode.
+  constexpr int kStableLubyUnit = 1024;
+  // Smoothing factors of the moving averages of LBD, the margin by which the
+  // fast one must exceed the slow one to restart, and the conflicts at least
+  // between two such restarts.
+  // @see: Audemard, G., Simon, L.: Refining Restarts Strategies for SAT and
+  //       UNSAT. In: Principles and Practice of Constraint Programming 2012.
+  //       pp. 118–126. Springer Berlin Heidelberg (2012)
+  constexpr double kFastLBDAlpha = 1. / 32;
+  constexpr double kSlowLBDAlpha = 1e-5;
+  constexpr double kRestartMargin = 1.1;
+  constexpr int64_t kMinRestartInterval = 2;
+  // Conflicts in each of the first two modes when switching modes, doubling
+  // every two switches.
+  constexpr int64_t kModeInterval = 1000;
+  // Conflicts between polls for clauses learned elsewhere.
+  constexpr int64_t kImportInterval = 1024;
+  // Conflicts before the first reset of the phases, the interval growing by
+  // as many after each reset.
+  constexpr int64_t kRephaseInterval = 1000;
+  // Phases taken in turn when rephasing: those of local search (W), of the
+  // longest trail (B), the initial ones (O) and their inverses (I). Going back
+  // to the initial phases throws away much of what the search learned, so
+  // it's done rarely.
+  constexpr char kRephaseCycle[] = "WBWBWBWOWBWBWBWI";
+  // Flips of local search per propagation since it last ran, and at least.
+  constexpr double kWalkEffort = 0.1;
+  constexpr int64_t kMinWalkFlips = 1 << 14;
+  // Flips between checks of the budget.
+  constexpr int64_t kWalkCheckFlips = 1 << 12;
+
+  if (!state_) {
+    state_ = std::make_unique<State>(
+        clauses_, seeded_ ? seed_ : std::random_device()());
+  }
+  state_->Grow(NumVars(), phase_);
+  state_->learned.SetMemoryLimit(memoryLimit_);
+  failed_.clear();
 
-  const size_t kFirstLearnedClause = clauses_.size();
-
-  std::random_device rdev;
-  std::mt19937 rng(rdev());
+  std::mt19937 &rng = state_->rng;
   std::bernoulli_distribution randDecision(.02);
 
   // Trail data:
   //
-  //   L      = trail literals
-  //   reason = index of the reason clause for l or -1 if decision.
-  //   lloc   = location of decision level d in the trail.
-  //   b      = literals of learned clause when resolving conflicts.
-  //   used   = whether a clause is the reason of a literal in the trail.
+  //   L         = trail literals
+  //   reason    = reference of the reason clause for l, kBinaryReason if l
+  //               was forced by a binary clause or kNullRef if decision. The
+  //               literal forced by a clause of size > 3 is its first one.
+  //   reasonLit = other literal of the binary reason clause for l, if any.
+  //   lloc      = location of decision level d in the trail.
+  //   b         = literals of learned clause when resolving conflicts.
+  //   conflict  = literals of the conflict clause being resolved.
+  constexpr CRef kNullRef = ClauseArena::kNullRef;
+  constexpr CRef kBinaryReason = ClauseArena::kNullRef - 1;
   std::vector<int> L;
-  std::vector<int> reason(2 * NumVars() + 2, -1);
+  std::vector<CRef> reason(2 * NumVars() + 2, kNullRef);
+  std::vector<int> reasonLit(2 * NumVars() + 2, 0);
   std::vector<int> lloc(NumVars() + 1, 0);
   std::vector<Lit> b;
-  std::vector<int> used;
+  std::vector<Lit> conflict;
+  Assignment model;
 
   // Variable data:
   //
@@ -343,7 +726,6 @@ std::pair<Result, Assignment> C::Solve() {
   //   stamp[k]        = stamp number used when resolving conflicts.
   //   level[k]        = current level k belongs to.
   //   val[k]          = current value of k (0=pos, 1=neg, -1=unset).
-  //   old[k]          = old value of k, used for phase saving.
   //   tloc[k]         = location of k in the trail, of -1 if not in the trail.
   //   redundant[k]    = cache to check whether a literal is redundant with
   //                     respect to learned clause. Positive/negative stamp
@@ -355,7 +737,7 @@ std::pair<Result, Assignment> C::Solve() {
   std::vector<int> stamp(NumVars() + 1, 0);
   std::vector<int> level(NumVars() + 1);
   std::vector<int> val(NumVars() + 1, -1);
-  std::vector<int> old(NumVars() + 1, 1);
+  std::vector<int> &old = state_->old;
   std::vector<int> tloc(NumVars() + 1, -1);
   std::vector<int> redundant(2 * NumVars() + 2, 0);
   std::vector<int> learnedStamp(2 * NumVars() + 2, -1);
@@ -366,7 +748,13 @@ std::pair<Result, Assignment> C::Solve() {
 
   // Activity heap management:
   //
-  ActivityHeap<double> heap(NumVars(), rng);
+  // Variables assigned when the previous call returned are put back.
+  ActivityHeap<double> &heap = state_->heap;
+  for (int k = 1; k <= NumVars(); ++k) {
+    if (!heap.Contains(k)) {
+      heap.Push(k);
+    }
+  }
   heap.CheckIntegrity();
 
   // Flushing and restarts:
@@ -378,16 +766,62 @@ std::pair<Result, Assignment> C::Solve() {
   int flushThreshold = 100;
   uint32_t agility = 0;
   ReluctantDoublingGenerator<int> rdgen;
+  // Maximum agility, scaled by 2^32, to flush after 2^i new clauses according
+  // to 7.2.2.2 - Table 4, p76.
+  std::array<double, 16> flushAgility;
+  for (int i = 0; i < 16; ++i) {
+    flushAgility[i] = std::pow(kTheta, i) * kPsi * std::pow(2., 32);
+  }
+
+  // Restart modes:
+  //
+  //   stable      = whether in stable mode rather than focused.
+  //   switches    = number of mode switches.
+  //   switched    = whether the mode switched since the last restart check.
+  //   nextSwitch  = conflicts at which the mode switches, if it does.
+  //   fastLBD     = fast moving average of the LBD of learned clauses.
+  //   slowLBD     = slow moving average of the LBD of learned clauses.
+  //   lastRestart = conflicts at the last restart.
+  //   target      = phases of the longest trail since the last restart.
+  //   targetTrail = length of that trail.
+  bool stable = restarts_ == Restarts::kStable;
+  int switches = 0;
+  bool switched = false;
+  int64_t nextSwitch = state_->stats.conflicts + kModeInterval;
+  ReluctantDoublingGenerator<int> stableGen;
+  EMA fastLBD(kFastLBDAlpha);
+  EMA slowLBD(kSlowLBDAlpha);
+  int64_t lastRestart = state_->stats.conflicts;
+  std::vector<int> target(old);
+  size_t targetTrail = 0;
+
+  // Clause sharing:
+  //
+  //   nextImport = conflicts at which clauses learned elsewhere are imported.
+  //   imported   = clauses imported.
+  int64_t nextImport = 0;
+  std::vector<SharedClause> imported;
 
-  // Purging:
+  // Rephasing:
   //
-  bool purging = false;
-  int purgeLevel = -1;
-  int purgeThreshold = 10000;
+  //   best      = phases of the longest trail since the last rephasing.
+  //   bestTrail = length of that trail.
+  std::vector<int> &best = state_->best;
+  size_t bestTrail = 0;
+
+  // Learned clauses:
+  //
+  //   lbdStamp      = latest stamp number used when computing LBD.
+  //   levelStamp[j] = stamp at which decision level j was last counted.
+  LearnedClauses &learned = state_->learned;
+  int lbdStamp = 0;
+  std::vector<int> levelStamp(NumVars() + 1, 0);
 
   // Stats:
   //
-  Stats stats;
+  Stats &stats = state_->stats;
+  const Stats startStats = stats;
+  StartSearch();
 
   // State:
   //
@@ -396,7 +830,11 @@ std::pair<Result, Assignment> C::Solve() {
   int dd;       // backjump level after resolving a conflict.
   int l;        // currently selected literal.
   size_t g = 0; // current trail position, behind the trail head.
-  int cc;       // index of conflict clause.
+  CRef cc;      // conflict clause, or kBinaryReason for (¬l ∨ ccLit).
+  int ccLit;    // other literal of a binary conflict clause.
+  uint32_t lbd; // literal block distance of the learned clause.
+  CRef lastLearned = kNullRef; // most recently learned clause.
+  size_t na = 0; // number of leading assumptions known to be true.
 
   // Some closures to check whether a literal is currently free, true or false.
   auto IsFree = [&](const Lit &l) { return val[l.VID()] == -1; };
@@ -407,6 +845,61 @@ std::pair<Result, Assignment> C::Solve() {
     return !IsFree(l) && l.IsPos() != (val[l.VID()] == 0);
   };
 
+  // Checks whether clause cr is currently the reason of a literal in the trail.
+  auto IsLocked = [&](CRef cr) {
+    const auto c = clauses_[cr];
+    return std::any_of(c.begin(), c.end(),
+                       [&](const Lit &lit) { return reason[lit.ID()] == cr; });
+  };
+
+  // Computes the literal block distance of the literals in [first, last),
+  // which must all be assigned.
+  // @see: Audemard, G., Simon, L.: Predicting Learnt Clauses Quality in Modern
+  //       SAT Solvers. In: IJCAI 2009. pp. 399–404 (2009)
+  auto ComputeLBD = [&](const Lit *first, const Lit *last) {
+    ++lbdStamp;
+    uint32_t lbd = 0;
+    for (; first != last; ++first) {
+      const int j = level[first->VID()];
+      if (levelStamp[j] != lbdStamp) {
+        levelStamp[j] = lbdStamp;
+        ++lbd;
+      }
+    }
+    return lbd;
+  };
+
+  // Sets literal u at the current level, forced by the given reason.
+  auto Force = [&](const Lit &u, CRef r) {
+    const int x = u.VID();
+    tloc[x] = static_cast<int>(L.size());
+    val[x] = u.IsPos() ? 0 : 1;
+    level[x] = d;
+    L.push_back(u.ID());
+    reason[u.ID()] = r;
+    agility = agility - (agility >> 13) + (((old[x] - val[x]) & 1) << 19);
+    ++stats.propagations;
+  };
+
+  // Calls fn for every literal in the reason of li.
+  auto ForEachReasonLit = [&](int li, const auto &fn) {
+    if (reason[li] == kBinaryReason) {
+      fn(Lit(li));
+      fn(Lit(reasonLit[li]));
+    } else {
+      for (const auto &ll : clauses_[reason[li]]) {
+        fn(ll);
+      }
+    }
+  };
+
+  // Builds a string representing the reason of li.
+  auto ReasonString = [&](int li) {
+    std::vector<Lit> c;
+    ForEachReasonLit(li, [&](const Lit &ll) { c.push_back(ll); });
+    return ToString(c);
+  };
+
   // Builds a string representing the current trail. Useful for debugging and
   // reporting.
   auto TrailString = [&]() {
@@ -419,8 +912,7 @@ std::pair<Result, Assignment> C::Solve() {
       out << "\t" << std::setw(4) << t << " " << std::setw(5 + (L[t] & 1))
           << ToString(Lit(L[t])) << " " << std::setw(5) << level[L[t] >> 1]
           << " "
-          << (reason[L[t]] == -1 ? "Λ"
-                                 : "(" + ToString(clauses_[reason[L[t]]]) + ")")
+          << (reason[L[t]] == kNullRef ? "Λ" : "(" + ReasonString(L[t]) + ")")
           << '\n';
     }
     return out.str();
@@ -443,50 +935,52 @@ std::pair<Result, Assignment> C::Solve() {
       redundant[li] = latestStamp;
       return true;
     }
-    if (reason[li ^ 1] == -1) {
+    if (reason[li ^ 1] == kNullRef) {
       redundant[li] = -latestStamp;
       return false;
     }
-    for (const auto &ll : clauses_[reason[li ^ 1]]) {
+    auto covered = [&](const Lit &ll) {
       const auto xj = ll.VID();
-      if (IsFalse(ll)) {
-        // Instead of checking naively whether xj belongs to the learned clause,
-        // we can use the stamp and level.
-        if ((stamp[xj] == latestStamp && level[xj] < d) || IsRedundant(c, ll)) {
-        } else {
-          redundant[li] = -latestStamp;
-          return false;
-        }
-      }
+      // Instead of checking naively whether xj belongs to the learned clause,
+      // we can use the stamp and level.
+      return !IsFalse(ll) || (stamp[xj] == latestStamp && level[xj] < d) ||
+             IsRedundant(c, ll);
+    };
+    bool ok;
+    if (reason[li ^ 1] == kBinaryReason) {
+      ok = covered(Lit(reasonLit[li ^ 1]));
+    } else {
+      const auto r = clauses_[reason[li ^ 1]];
+      ok = std::all_of(r.begin(), r.end(), covered);
     }
-    redundant[li] = latestStamp;
-    return true;
+    redundant[li] = ok ? latestStamp : -latestStamp;
+    return ok;
   };
 
 C1: // Initialize.
   L.reserve(NumVars() + 1);
-  for (int i = 0; i < NumClauses(); ++i) {
-    used.push_back(0);
-    if (clauses_[i].empty()) { // empty clause
+  for (auto it = clauses_.begin(); it != clauses_.end(); ++it) {
+    const auto c = *it;
+    if (c.empty()) { // empty clause
       return {Result::kUNSAT, {}};
-    } else if (clauses_[i].size() == 1) { // unit clause
-      LOG << "C1: L(" << L.size() << ")=" << ToString(clauses_[i][0])
-          << " with reason (" << ToString(clauses_[i]) << ")";
-      if (!IsFree(clauses_[i][0])) {
+    } else if (c.size() == 1) { // unit clause
+      LOG << "C1: L(" << L.size() << ")=" << ToString(c[0]) << " with reason ("
+          << ToString(c) << ")";
+      if (IsTrue(c[0])) {
+        continue;
+      } else if (IsFalse(c[0])) {
         LOG << "C1: instance contains contradictory unit clauses ("
-            << ToString(clauses_[i][0]) << ") and ("
-            << ToString(~clauses_[i][0]) << ")";
+            << ToString(c[0]) << ") and (" << ToString(~c[0]) << ")";
         return {Result::kUNSAT, {}};
       }
-      const int x0 = clauses_[i][0].VID();
+      const int x0 = c[0].VID();
       tloc[x0] = static_cast<int>(L.size());
-      val[x0] = clauses_[i][0].IsPos() ? 0 : 1;
+      val[x0] = c[0].IsPos() ? 0 : 1;
       level[x0] = 0;
-      L.push_back(clauses_[i][0].ID());
-      reason[clauses_[i][0].ID()] = i;
-      used.back() = clauses_[i][0].ID();
+      L.push_back(c[0].ID());
+      reason[c[0].ID()] = it.Ref();
     }
-    w.Watch(i);
+    w.Watch(it.Ref());
   }
 
 C2: // Level complete?
@@ -502,9 +996,50 @@ C3: // Advance G.
   ++g;
   LOG << "C3: advance to G=" << g - 1 << ": l=" << ToString(Lit(l));
 
-  cc = -1;
+  cc = kNullRef;
+
+  // Binary clauses force their other literal right away.
+  for (const Lit &u : w.Binary(l ^ 1)) {
+    if (IsTrue(u)) {
+      continue;
+    }
+    if (IsFalse(u)) {
+      cc = kBinaryReason;
+      ccLit = u.ID();
+      goto C7;
+    }
+    LOG << "C4: L(" << L.size() << ")=" << ToString(u)
+        << " forced with reason (" << ToString(Lit(l ^ 1)) << ", "
+        << ToString(u) << ")";
+    reasonLit[u.ID()] = l ^ 1;
+    Force(u, kBinaryReason);
+  }
+
+  // Ternary clauses are watched on every literal, so they never need to look
+  // for a replacement watchee.
+  for (const auto &t : w.Ternary(l ^ 1)) {
+    if (IsTrue(t.a) || IsTrue(t.b)) {
+      continue;
+    }
+    if (IsFalse(t.a) && IsFalse(t.b)) {
+      cc = t.cref;
+      goto C7;
+    }
+    if (IsFalse(t.a) || IsFalse(t.b)) {
+      const Lit u = IsFalse(t.a) ? t.b : t.a;
+      LOG << "C4: L(" << L.size() << ")=" << ToString(u)
+          << " forced with reason (" << ToString(clauses_[t.cref]) << ")";
+      Force(u, t.cref);
+    }
+  }
+
   for (auto it = w.Iterate(l ^ 1); it;) {
-    auto &c = clauses_[*it];
+    // Skip the clause without visiting it if it's satisfied by its blocker.
+    if (IsTrue(it.Blocker())) {
+      ++it;
+      continue;
+    }
+    auto c = clauses_[*it];
     CHECK(c.size() > 1) << "unit clauses cannot appear in watch lists";
     CHECK(c[0].ID() == (l ^ 1) || c[1].ID() == (l ^ 1))
         << "clause #" << *it << " (" << ToString(c) << ") should be watching "
@@ -514,10 +1049,10 @@ C3: // Advance G.
   C4: // Does c force a unit?
     if (c[0].ID() == (l ^ 1)) {
       std::swap(c[0], c[1]);
-      it.Swap();
     }
     if (IsTrue(c[0])) {
       // While c[0] is true, this clause won't be falsified.
+      it.SetBlocker(c[0]);
       ++it;
       continue;
     }
@@ -534,209 +1069,270 @@ C3: // Advance G.
     if (!hasAlt) {
       // If there is no alternative and c[0] is false, this is a conflict.
       if (IsFalse(c[0])) {
-        // If we are doing a purging run, we can continue and ignore the
-        // conflicts for now.
-        if (purging) {
-          ++it;
-        } else {
-          cc = *it;
-          goto C7;
-        }
+        cc = *it;
+        goto C7;
       } else {
         // Otherwise, we can set c[0] if it's free.
         CHECK(IsFree(c[0]))
             << "literal " << ToString(c[0]) << " must be free at this point.";
         LOG << "C4: L(" << L.size() << ")=" << ToString(c[0])
             << " forced with reason (" << ToString(clauses_[*it]) << ")";
-        const int l0 = c[0].ID();
-        const int x0 = c[0].VID();
-        tloc[x0] = static_cast<int>(L.size());
-        val[x0] = c[0].IsPos() ? 0 : 1;
-        level[x0] = d;
-        L.push_back(l0);
-        used[*it] = l0;
-        reason[l0] = *it;
-        agility = agility - (agility >> 13) + (((old[x0] - val[x0]) & 1) << 19);
+        Force(c[0], *it);
+        it.SetBlocker(c[0]);
         ++it;
-        ++stats.propagations;
       }
     }
   }
   goto C2; // no conflicts.
 
 C5: // New level?
+  if (Interrupted(stats.conflicts - startStats.conflicts,
+                  stats.propagations - startStats.propagations)) {
+    LOG << "C5: interrupted: " << stats.ToString();
+    return {Result::kUnknown, {}};
+  }
+  // Assumptions are decided before any other literal. Those already true are
+  // skipped, while a false one means that the instance is unsatisfiable under
+  // the assumptions.
+  while (na < assumptions.size() && IsTrue(assumptions[na])) {
+    ++na;
+  }
+  if (na < assumptions.size() && IsFalse(assumptions[na])) {
+    const Lit a = assumptions[na];
+    LOG << "C5: assumption " << ToString(a) << " is false" << TrailString();
+    // Walk the trail back from ¬a, collecting the assumptions implying it,
+    // which are the decisions reached.
+    failed_.push_back(a);
+    stamp[a.VID()] = latestStamp;
+    for (int tt = tloc[a.VID()]; tt >= 0 && level[L[tt] >> 1] > 0; --tt) {
+      if (stamp[L[tt] >> 1] != latestStamp) {
+        continue;
+      }
+      if (reason[L[tt]] == kNullRef) {
+        // Every decision below the current assumption is itself an
+        // assumption, ¬a included if both a and ¬a are assumed.
+        failed_.push_back(Lit(L[tt]));
+      } else {
+        ForEachReasonLit(L[tt],
+                         [&](const Lit &ll) { stamp[ll.VID()] = latestStamp; });
+      }
+    }
+    return {Result::kUNSAT, {}};
+  }
   if (L.size() == NumVars()) {
-    // Check if we are doing a purging run, in which case, the trail now
-    // contains every variable and we can compute the literal block distance for
-    // each clause. Otherwise, we found a satisfiable assignment.
-    if (!purging) {
-      Assignment sol;
-      for (const auto &l : L) {
-        sol.emplace_back(l);
-      }
-      return {Result::kSAT, sol};
-    } else {
-      constexpr float kAlpha = 15.f / 16;
-      const int kKeepTarget = (clauses_.size() - kFirstLearnedClause) / 2;
-      std::vector<int> range(clauses_.size() - kFirstLearnedClause, 0);
-      std::array<int, 257> rangeFreq;
-      std::fill(rangeFreq.begin(), rangeFreq.end(), 0);
-      for (size_t i = kFirstLearnedClause; i < clauses_.size(); ++i) {
-        const size_t idx = i - kFirstLearnedClause;
-        if (!used[i]) {
-          // Compute literal block distance.
-          int p = 0;
-          int q = 0;
-          std::vector<std::array<int, 2>> levelFreq(NumVars() + 1, {0, 0});
-          for (const auto &lit : clauses_[i]) {
-            if (level[lit.VID()] == 0) {
-              range[idx] = 256;
-              break;
-            }
-            ++levelFreq[level[lit.VID()]][lit.IsNeg()];
-          }
-          if (range[idx] < 256) {
-            for (int i = 0; i <= NumVars(); ++i) {
-              if (levelFreq[i][0] > 0) {
-                ++p;
-              } else if (levelFreq[i][1] > 0) {
-                ++q;
-              }
-            }
-            range[idx] = std::min(
-                static_cast<int>(std::floor(16 * (p + kAlpha * q))), 255);
-          }
-        }
-        ++rangeFreq[range[idx]];
-      }
-
-      int targetRange = 1;
-      int sum = rangeFreq[0];
-      while (targetRange < 256 && sum + rangeFreq[targetRange] <= kKeepTarget) {
-        sum += rangeFreq[targetRange];
-        ++targetRange;
-      }
-      for (size_t i = kFirstLearnedClause; i < clauses_.size();) {
-        if (range[i - kFirstLearnedClause] >= targetRange) {
-          LOG << "C5: purged clause (" << ToString(clauses_[i]) << ")";
-          std::swap(clauses_[i], clauses_.back());
-          std::swap(range[i - kFirstLearnedClause], range.back());
-          if (used.back()) {
-            reason[used.back()] = i;
+    if (onModel != nullptr) {
+      goto C10;
+    }
+    Assignment sol;
+    for (const auto &l : L) {
+      sol.emplace_back(l);
+    }
+    return {Result::kSAT, sol};
+  } else if (learned.ShouldReduce(stats.conflicts)) {
+    LOG << "C5: purge at level d=" << d;
+    stats.purged += learned.Reduce(stats.conflicts, IsLocked);
+    // Reclaim the memory of purged clauses, keeping the reasons in sync. The
+    // watched literals of the remaining clauses don't change, so the watch
+    // lists can be rebuilt as they are. While listing models, the memory is
+    // reclaimed once done instead, so that clauses keep their order.
+    if (onModel == nullptr) {
+      clauses_.Compact([&](CRef from, CRef to) {
+        for (const auto &lit : clauses_[to]) {
+          if (reason[lit.ID()] == from) {
+            reason[lit.ID()] = to;
           }
-          used[i] = used.back();
-          clauses_.pop_back();
-          range.pop_back();
-          used.pop_back();
-          ++stats.purged;
-        } else {
-          ++i;
         }
-      }
-      w.Rebuild();
-
-      // Backjump to original decision level where purge was started.
-      while (L.size() > lloc[purgeLevel + 1]) {
+      });
+    }
+    lastLearned = kNullRef;
+    w.Rebuild();
+  } else if (importFn_ && onModel == nullptr &&
+             stats.conflicts >= nextImport) {
+    nextImport = stats.conflicts + kImportInterval;
+    imported.clear();
+    importFn_(imported);
+    if (!imported.empty()) {
+      LOG << "C5: importing " << imported.size() << " clauses at d=" << d;
+      ++stats.restarts;
+      while (d > 0 && L.size() > lloc[1]) {
         l = L.back();
         const int k = l >> 1;
         old[k] = val[k];
         val[k] = -1;
         level[k] = -1;
-        if (reason[l] != -1) {
-          Clause &c = clauses_[reason[l]];
-          const bool falsified = (IsFalse(c[0]) && level[c[0].VID()] <= dd) ||
-                                 (IsFalse(c[1]) && level[c[1].VID()] <= dd);
-          if (falsified) {
-            w.Forget(reason[l]);
-            for (size_t off = 0; off < 2; ++off) {
-              if (IsFalse(c[off]) && level[c[off].VID()] <= dd) {
-                for (size_t i = 1 + off; i < c.size(); ++i) {
-                  if (!IsFalse(c[i]) || level[c[i].VID()] > dd) {
-                    std::swap(c[off], c[i]);
-                    break;
-                  }
-                }
-              }
-            }
-            w.Watch(reason[l]);
-          }
-
-          used[reason[l]] = 0;
-          reason[l] = -1;
-        }
+        reason[l] = kNullRef;
         if (!heap.Contains(k)) {
           heap.Push(k);
         }
         L.pop_back();
       }
       g = L.size();
-      d = purgeLevel;
-      // End purge run.
-      purging = false;
-      purgeLevel = 0;
-      LOG << "C5: purge completed";
-    }
-  } else if (!purging && m >= purgeThreshold) {
-    LOG << "C5: purge run begin at level d=" << d;
-    purging = true;
-    purgeLevel = d;
-    purgeThreshold = m + 10000;
-  } else if (!purging && m >= flushThreshold) {
-    const int delta = rdgen();
-    flushThreshold = m + delta;
-    bool flush = false;
-    const float a = agility / std::pow(2.f, 32);
-    // Flush schedule according to 7.2.2.2 - Table 4, p76.
-    for (int i = 0; i < 16; ++i) {
-      if (delta == (1 << i)) {
-        flush = a <= std::pow(kTheta, i) * kPsi;
-        break;
+      d = 0;
+      na = 0;
+      // At level 0, the false literals of a clause can be left out, and any
+      // remaining literal is free.
+      for (const auto &[c, clbd] : imported) {
+        b.clear();
+        bool satisfied = false;
+        for (const auto &lit : c) {
+          satisfied = satisfied || IsTrue(lit);
+          if (IsFree(lit)) {
+            b.push_back(lit);
+          }
+        }
+        if (satisfied) {
+          continue;
+        }
+        if (b.empty()) {
+          LOG << "C5: imported clause (" << ToString(c) << ") is false";
+          return {Result::kUNSAT, {}};
+        }
+        const CRef cr = clauses_.Alloc(b.data(), b.size(), true);
+        learned.Add(cr, clbd);
+        w.Watch(cr);
+        if (b.size() == 1) {
+          Force(b[0], cr);
+        }
       }
+      lastLearned = kNullRef;
+      goto C2;
     }
-    if (flush) {
-      int xk = heap.Top();
-      while (val[xk] >= 0) {
-        heap.Pop();
-        xk = heap.Top();
+  } else if (rephase_ && onModel == nullptr &&
+             stats.conflicts >= kRephaseInterval * (state_->rephases + 1) *
+                                    (state_->rephases + 2) / 2) {
+    const char phase =
+        kRephaseCycle[state_->rephases % (sizeof(kRephaseCycle) - 1)];
+    LOG << "C5: rephasing with phases " << phase << " at d=" << d;
+    ++state_->rephases;
+    ++stats.rephases;
+    stats.restarts += d > 0;
+    while (d > 0 && L.size() > lloc[1]) {
+      l = L.back();
+      const int k = l >> 1;
+      old[k] = val[k];
+      val[k] = -1;
+      level[k] = -1;
+      reason[l] = kNullRef;
+      if (!heap.Contains(k)) {
+        heap.Push(k);
       }
-      CHECK(xk > 0) << "invalid unassigned variable of maximum activity: xk="
-                    << xk;
+      L.pop_back();
+    }
+    g = L.size();
+    d = 0;
+    na = 0;
+    if (phase == 'B') {
+      old = best;
+    } else if (phase == 'O' || phase == 'I') {
+      for (int k = 1; k <= NumVars(); ++k) {
+        old[k] = state_->initial[k] ^ (phase == 'I');
+      }
+    } else {
+      // Walk from the saved phases over the original clauses, as simplified
+      // at level 0, and take the values leaving the fewest of them false.
+      LocalSearch::Instance in(NumVars());
+      for (const auto c : clauses_) {
+        if (c.Learned()) {
+          continue;
+        }
+        b.clear();
+        bool satisfied = false;
+        for (const auto &lit : c) {
+          satisfied = satisfied || IsTrue(lit);
+          if (IsFree(lit)) {
+            b.push_back(lit);
+          }
+        }
+        if (!satisfied) {
+          in.Add(b);
+        }
+      }
+      in.Index();
+      if (!in.empty) {
+        std::vector<char> values(NumVars() + 1, 0);
+        for (int k = 1; k <= NumVars(); ++k) {
+          values[k] = old[k] == 0;
+        }
+        LocalSearch walk(in, LocalSearch::Mode::kProbSAT, 0, rng(), values);
+        const int64_t flips = std::max(
+            kMinWalkFlips, static_cast<int64_t>(
+                               kWalkEffort *
+                               (stats.propagations - state_->lastWalk)));
+        for (int64_t n = 0; n < flips && !walk.Run(kWalkCheckFlips);
+             n += kWalkCheckFlips) {
+          if (Interrupted(stats.conflicts - startStats.conflicts,
+                          stats.propagations - startStats.propagations)) {
+            stats.flips += walk.NumFlips();
+            LOG << "C5: interrupted: " << stats.ToString();
+            return {Result::kUnknown, {}};
+          }
+        }
+        stats.flips += walk.NumFlips();
+        state_->lastWalk = stats.propagations;
+        LOG << "C5: local search left " << walk.BestUnsat() << " of "
+            << in.NumClauses() << " clauses false";
+        for (int k = 1; k <= NumVars(); ++k) {
+          old[k] = walk.Best()[k] ? 0 : 1;
+        }
+      }
+    }
+    bestTrail = 0;
+    target = old;
+    targetTrail = 0;
+    goto C2;
+  } else if (m >= flushThreshold) {
+    // A switch of modes restarts regardless of the policy of the new mode.
+    bool flush = switched;
+    switched = false;
+    if (stable) {
+      flushThreshold = m + kStableLubyUnit * stableGen();
+      flush = true;
+    } else if (restarts_ == Restarts::kGlucose ||
+               restarts_ == Restarts::kSwitching) {
+      flushThreshold = m + 1;
+      flush = flush ||
+              (stats.conflicts - lastRestart >= kMinRestartInterval &&
+               fastLBD.Value() > kRestartMargin * slowLBD.Value());
+    } else if (restarts_ == Restarts::kLuby) {
+      flushThreshold = m + kLubyUnit * rdgen();
+      flush = true;
+    } else {
+      const int delta = rdgen();
+      flushThreshold = m + delta;
+      for (int i = 0; i < 16; ++i) {
+        if (delta == (1 << i)) {
+          flush = agility <= flushAgility[i];
+          break;
+        }
+      }
+    }
+    if (flush) {
       dd = 0;
-      while (dd < d &&
-             heap.GetActivity(L[lloc[dd]] >> 1) >= heap.GetActivity(xk)) {
-        ++dd;
+      if (restarts_ == Restarts::kFlush) {
+        int xk = heap.Top();
+        while (val[xk] >= 0) {
+          heap.Pop();
+          xk = heap.Top();
+        }
+        CHECK(xk > 0) << "invalid unassigned variable of maximum activity: xk="
+                      << xk;
+        while (dd < d &&
+               heap.GetActivity(L[lloc[dd]] >> 1) >= heap.GetActivity(xk)) {
+          ++dd;
+        }
       }
       if (dd < d) {
         LOG << "C5: flushing from d=" << d << " to d'=" << dd;
         ++stats.restarts;
+        lastRestart = stats.conflicts;
+        targetTrail = 0;
         while (L.size() > lloc[dd + 1]) {
           l = L.back();
           const int k = l >> 1;
           old[k] = val[k];
           val[k] = -1;
           level[k] = -1;
-          if (reason[l] != -1) {
-            Clause &c = clauses_[reason[l]];
-            const bool falsified = (IsFalse(c[0]) && level[c[0].VID()] <= dd) ||
-                                   (IsFalse(c[1]) && level[c[1].VID()] <= dd);
-            if (falsified) {
-              w.Forget(reason[l]);
-              for (size_t off = 0; off < 2; ++off) {
-                if (IsFalse(c[off]) && level[c[off].VID()] <= dd) {
-                  for (size_t i = 1 + off; i < c.size(); ++i) {
-                    if (!IsFalse(c[i]) || level[c[i].VID()] > dd) {
-                      std::swap(c[off], c[i]);
-                      break;
-                    }
-                  }
-                }
-              }
-              w.Watch(reason[l]);
-            }
-
-            used[reason[l]] = 0;
-            reason[l] = -1;
-          }
+          reason[l] = kNullRef;
           if (!heap.Contains(k)) {
             heap.Push(k);
           }
@@ -744,6 +1340,7 @@ C5: // New level?
         }
         g = L.size();
         d = dd;
+        na = 0;
         goto C2;
       }
     }
@@ -756,10 +1353,16 @@ C5: // New level?
 C6 : // Make a decision.
 {
   int k;
-  // With small probability, take a random decision rather than using the
-  // variable with maximum activity score.
+  // Pending assumptions are decided first. Otherwise, with small probability,
+  // take a random decision rather than using the variable with maximum
+  // activity score.
   // @see: 7.2.2.2 - exercise 267, p155
-  if (randDecision(rng)) {
+  if (na < assumptions.size()) {
+    l = assumptions[na].ID();
+    k = l >> 1;
+    ++na;
+    LOG << "C6: L[" << L.size() << "]=" << ToString(Lit(l)) << " by assumption";
+  } else if (randDecision(rng)) {
     std::vector<int> free;
     for (int k = 1; k <= NumVars(); ++k) {
       if (val[k] == -1) {
@@ -769,7 +1372,7 @@ C6 : // Make a decision.
     std::shuffle(free.begin(), free.end(), rng);
 
     k = free[0];
-    l = 2 * k + (old[k] & 1);
+    l = 2 * k + ((stable ? target[k] : old[k]) & 1);
     LOG << "C6: L[" << L.size() << "]=" << ToString(Lit(l))
         << " by random decision";
   } else {
@@ -781,7 +1384,7 @@ C6 : // Make a decision.
       if (val[k] >= 0) {
         continue;
       }
-      l = 2 * k + (old[k] & 1);
+      l = 2 * k + ((stable ? target[k] : old[k]) & 1);
       LOG << "C6: L[" << L.size() << "]=" << ToString(Lit(l)) << " by decision";
       break;
     }
@@ -796,7 +1399,7 @@ C6 : // Make a decision.
   val[k] = l & 1;
   level[k] = d;
   tloc[k] = static_cast<int>(L.size());
-  reason[l] = -1;
+  reason[l] = kNullRef;
   L.push_back(l);
   agility = agility - (agility >> 13) + (((old[k] - val[k]) & 1) << 19);
   CHECK(L.size() == g + 1) << "the trace should be only one step ahead: G=" << g
@@ -804,28 +1407,154 @@ C6 : // Make a decision.
   goto C3;
 }
 
+C10: // Block the model.
+{
+  // Only the values of non-temporary variables make a model different.
+  model.clear();
+  for (int x = 1; x <= NumVars(); ++x) {
+    if (!isTemp_[x - 1]) {
+      model.push_back(val[x] == 0 ? Lit(Var(x)) : ~Var(x));
+    }
+  }
+  LOG << "C10: model [" << ToString(model) << "]";
+  if (!(*onModel)(model)) {
+    return {Result::kSAT, {}};
+  }
+
+  // The blocking clause only needs the non-temporary literals that aren't
+  // implied by earlier literals in it. Going through the trail in order,
+  // stamped variables are those whose values follow from the blocking clause.
+  ++latestStamp;
+  b.clear();
+  for (const int u : L) {
+    const int x = u >> 1;
+    bool implied = level[x] == 0;
+    if (!implied && reason[u] != kNullRef) {
+      implied = true;
+      ForEachReasonLit(u, [&](const Lit &ll) {
+        implied = implied && (ll.VID() == x || stamp[ll.VID()] == latestStamp);
+      });
+    }
+    if (implied || !isTemp_[x - 1]) {
+      stamp[x] = latestStamp;
+      if (!implied) {
+        b.push_back(~Lit(u));
+      }
+    }
+  }
+  ++latestStamp;
+  if (b.empty()) {
+    // The projection is fixed at level 0, so there's no other model.
+    return {Result::kUNSAT, {}};
+  }
+
+  // Watch the literals of the highest levels, which are unassigned first.
+  for (size_t i = 0; i < b.size() && i < 2; ++i) {
+    for (size_t j = i + 1; j < b.size(); ++j) {
+      if (level[b[j].VID()] > level[b[i].VID()]) {
+        std::swap(b[i], b[j]);
+      }
+    }
+  }
+  const int top = level[b[0].VID()];
+  const int next = b.size() > 1 ? level[b[1].VID()] : 0;
+  // Backtracking stops at the highest level where the clause is unit, or
+  // right below the top level if it has several literals there, while
+  // restarting always goes back to level 0.
+  dd = backtrack_ ? (next < top ? next : top - 1) : 0;
+  const bool unit = b.size() == 1 || level[b[1].VID()] <= dd;
+  LOG << "C10: blocking clause (" << ToString(b) << "), back to d=" << dd;
+  while (L.size() > lloc[dd + 1]) {
+    l = L.back();
+    const int k = l >> 1;
+    reason[l] = kNullRef;
+    old[k] = val[k];
+    val[k] = -1;
+    level[k] = -1;
+    if (!heap.Contains(k)) {
+      heap.Push(k);
+    }
+    L.pop_back();
+  }
+  g = L.size();
+  d = dd;
+  na = 0;
+
+  // Blocking clauses are learned clauses that are never reduced.
+  const CRef cr = clauses_.Alloc(b.data(), b.size(), true);
+  clauses_[cr].Header().transient = true;
+  learned.Add(cr, 0);
+  lastLearned = kNullRef;
+  w.Watch(cr);
+  if (unit) {
+    if (b.size() == 2) {
+      reasonLit[b[0].ID()] = b[1].ID();
+    }
+    Force(b[0], b.size() == 2 ? kBinaryReason : cr);
+  }
+  goto C2;
+}
+
 C7: // Resolve a conflict.
   if (d == 0) {
     LOG << "C6: stats: agility=" << (agility / std::pow(2, 32)) << " "
         << stats.ToString();
     return {Result::kUNSAT, {}};
   } else {
-    LOG << "C7: resolving conflict clause (" << ToString(clauses_[cc]) << ")"
+    // Binary conflicts are (¬l ∨ ccLit) and never stored in the arena.
+    if (cc == kBinaryReason) {
+      conflict.assign({Lit(l ^ 1), Lit(ccLit)});
+    } else {
+      conflict.assign(clauses_[cc].begin(), clauses_[cc].end());
+      learned.Bump(cc, ComputeLBD);
+    }
+    LOG << "C7: resolving conflict clause (" << ToString(conflict) << ")"
         << TrailString();
-    CHECK(clauses_[cc][1].ID() == (l ^ 1))
-        << "conflict clause cc=" << cc << " should be watching "
+    CHECK(std::find(conflict.begin(), conflict.end(), Lit(l ^ 1)) !=
+          conflict.end())
+        << "conflict clause (" << ToString(conflict) << ") should contain "
         << ToString(Lit(l ^ 1));
-    for ([[maybe_unused]] const auto &ll : clauses_[cc]) {
+    for ([[maybe_unused]] const auto &ll : conflict) {
       CHECK(IsFalse(ll)) << "a conflict clause must be falsified";
     }
 
     ++stats.conflicts;
+    if (rephase_ && L.size() > bestTrail) {
+      bestTrail = L.size();
+      for (const int u : L) {
+        best[u >> 1] = u & 1;
+      }
+    }
+    if (stable && L.size() > targetTrail) {
+      targetTrail = L.size();
+      for (const int u : L) {
+        target[u >> 1] = u & 1;
+      }
+    }
+    if (restarts_ == Restarts::kSwitching && stats.conflicts >= nextSwitch) {
+      ++switches;
+      ++stats.switches;
+      stable = !stable;
+      nextSwitch = stats.conflicts + (kModeInterval << (switches / 2));
+      LOG << "C7: switching to " << (stable ? "stable" : "focused")
+          << " mode until " << nextSwitch << " conflicts";
+      // Restart right away in the new mode.
+      switched = true;
+      flushThreshold = m;
+      target = old;
+      targetTrail = 0;
+    }
+    if (Interrupted(stats.conflicts - startStats.conflicts,
+                    stats.propagations - startStats.propagations)) {
+      LOG << "C7: interrupted: " << stats.ToString();
+      return {Result::kUnknown, {}};
+    }
 
     int dcnt = 0;
-    b.clear();
-    for (const auto &ll : clauses_[cc]) {
-      const int li = (~ll).ID();
-      const int ai = li >> 1;
+    // Stamps the variable of a false literal ll from the conflict or a reason
+    // clause, collecting it into the learned clause if it's below level d.
+    auto Resolve = [&](const Lit &ll) {
+      const int ai = ll.VID();
       if (stamp[ai] < latestStamp) {
         stamp[ai] = latestStamp;
         heap.Inc(ai);
@@ -835,6 +1564,10 @@ C7: // Resolve a conflict.
           b.push_back(ll);
         }
       }
+    };
+    b.clear();
+    for (const auto &ll : conflict) {
+      Resolve(ll);
     }
     for (size_t tt = L.size() - 1;; --tt) {
       // We only consider stamped literals.
@@ -846,22 +1579,13 @@ C7: // Resolve a conflict.
           std::swap(b[0], b.back());
           break;
         }
-        CHECK(reason[L[tt]] != -1)
+        CHECK(reason[L[tt]] != kNullRef)
             << "reasons during clause learning cannot be decisions: t'=" << tt
             << " L[" << tt << "]=" << L[tt] << TrailString();
-        for (const auto &ll : clauses_[reason[L[tt]]]) {
-          const int li = (~ll).ID();
-          const int ai = li >> 1;
-          if (stamp[ai] < latestStamp) {
-            stamp[ai] = latestStamp;
-            heap.Inc(ai);
-            if (level[ai] == d) {
-              ++dcnt;
-            } else if (level[ai] > 0) {
-              b.push_back(ll);
-            }
-          }
+        if (reason[L[tt]] != kBinaryReason) {
+          learned.Bump(reason[L[tt]], ComputeLBD);
         }
+        ForEachReasonLit(L[tt], Resolve);
         --dcnt;
       }
     }
@@ -904,36 +1628,24 @@ C7: // Resolve a conflict.
     }
     CHECK(dd < d) << "backjump level d'=" << dd
                   << " should be below current level d=" << d;
+    lbd = ComputeLBD(b.data(), b.data() + b.size());
+
+    // Watch a literal of level d' as second watchee, so that it's unassigned
+    // whenever l' is unassigned by a later backjump.
+    for (size_t i = 2; i < b.size(); ++i) {
+      if (level[b[i].VID()] > level[b[1].VID()]) {
+        std::swap(b[1], b[i]);
+      }
+    }
   }
 
 C8: // Backjump.
   while (L.size() > lloc[dd + 1]) {
     l = L.back();
     const int k = l >> 1;
-    if (reason[l] != -1) {
-      // We need to make sure clauses don't end up with falsified watchees.
-      // This can probably be improved but I need to think about it.
-      Clause &c = clauses_[reason[l]];
-      const bool falsified =
-          (~c[0] != b[0] && IsFalse(c[0]) && level[c[0].VID()] <= dd) ||
-          (~c[1] != b[0] && IsFalse(c[1]) && level[c[1].VID()] <= dd);
-      if (falsified) {
-        w.Forget(reason[l]);
-        for (size_t off = 0; off < 2; ++off) {
-          if (~c[off] != b[0] && IsFalse(c[off]) && level[c[off].VID()] <= dd) {
-            for (size_t i = 1 + off; i < c.size(); ++i) {
-              if (!IsFalse(c[i]) || level[c[i].VID()] > dd) {
-                std::swap(c[off], c[i]);
-                break;
-              }
-            }
-          }
-        }
-        w.Watch(reason[l]);
-      }
-      used[reason[l]] = 0;
-      reason[l] = -1;
-    }
+    // The second watchee of a reason clause is always assigned at the same
+    // level as the forced literal, so watches remain valid without repair.
+    reason[l] = kNullRef;
     old[k] = val[k];
     val[k] = -1;
     level[k] = -1;
@@ -944,6 +1656,7 @@ C8: // Backjump.
   }
   g = L.size();
   d = dd;
+  na = 0;
   LOG << "C8: backjump to d=" << d << " and G=" << g;
 
 C9: // Learn.
@@ -954,21 +1667,21 @@ C9: // Learn.
   // Check immediate subsumption.
   // @see: 7.2.2.2 - exercise 271, p156
   const bool subsumes =
+      lastLearned != kNullRef &&
       std::all_of(b.begin(), b.end(),
                   [&](const Lit &lit) {
                     return learnedStamp[lit.ID()] == latestStamp - 1;
                   }) &&
-      !used[static_cast<int>(clauses_.size() - 1)];
+      !IsLocked(lastLearned);
   if (subsumes) {
     LOG << "C9: learned clause (" << ToString(b) << "), immediately subsuming ("
-        << ToString(clauses_.back()) << ")";
+        << ToString(clauses_[lastLearned]) << ")";
 
     --stats.learnedClauses;
-    stats.clauseLength -= static_cast<int64_t>(clauses_.back().size());
+    stats.clauseLength -= static_cast<int64_t>(clauses_[lastLearned].size());
 
-    w.Forget(static_cast<int>(clauses_.size() - 1));
-    clauses_.pop_back();
-    used.pop_back();
+    w.Forget(lastLearned);
+    clauses_.Free(lastLearned);
   } else {
     LOG << "C9: learned clause (" << ToString(b) << ")";
   }
@@ -979,8 +1692,14 @@ C9: // Learn.
   }
   ++latestStamp;
   // Add new clause.
-  clauses_.push_back(b);
-  used.push_back(ll);
+  lastLearned = clauses_.Alloc(b.data(), b.size(), true);
+  clauses_[lastLearned].Header().transient = onModel != nullptr;
+  learned.Add(lastLearned, lbd);
+  fastLBD.Update(lbd);
+  slowLBD.Update(lbd);
+  if (exportFn_ && onModel == nullptr) {
+    exportFn_(b, lbd);
+  }
   ++m;
   // Update variable data.
   val[k] = ll & 1;
@@ -988,22 +1707,34 @@ C9: // Learn.
   tloc[k] = static_cast<int>(L.size());
   // Update trail.
   L.push_back(ll);
-  reason[ll] = static_cast<int>(clauses_.size() - 1);
+  if (b.size() == 2) {
+    reason[ll] = kBinaryReason;
+    reasonLit[ll] = b[1].ID();
+  } else {
+    reason[ll] = lastLearned;
+  }
   // Update activity.
   heap.Damp();
+  learned.Decay();
   agility = agility - (agility >> 13) + (((old[k] - val[k]) & 1) << 19);
   // Update watches.
-  w.Watch(static_cast<int>(clauses_.size() - 1));
+  w.Watch(lastLearned);
   // Update stats.
   ++stats.learnedClauses;
   stats.clauseLength += static_cast<int64_t>(b.size());
 
   goto C3;
+
 }
 
-std::pair<Result, std::vector<Assignment>> C::SolveAll() {
-  COMMENT << "this solver does not support listing all satisfying assignments";
-  return {Result::kUnknown, {}};
+void CopyTo(int numVars, const ClauseArena &clauses, C &to) {
+  to.Reserve(numVars, clauses.NumClauses(), clauses.Words());
+  for (int x = 1; x <= numVars; ++x) {
+    to.NewVar();
+  }
+  for (const auto c : clauses) {
+    to.AddClause(c.begin(), c.size());
+  }
 }
 
 } // namespace algorithm
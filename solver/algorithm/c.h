@@ -1,6 +1,10 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "solver/solver.h"
@@ -13,12 +17,149 @@ namespace algorithm {
  */
 class C : public Solver {
 public:
-  C() {}
+  // Value given to variables the first time they're decided, before phase
+  // saving takes over.
+  enum class Phase {
+    kNegative,
+    kPositive,
+    kRandom,
+  };
 
+  // When the search goes back to an earlier level to make better decisions.
+  enum class Restarts {
+    // Flushes literals of low activity while the agility is low, following the
+    // reluctant doubling sequence. See 7.2.2.2 - p75.
+    kFlush,
+    // Restarts from level 0 after a number of conflicts following the
+    // reluctant doubling (Luby) sequence, regardless of the agility.
+    kLuby,
+    // Restarts from level 0 when the LBD of the latest learned clauses, as a
+    // fast moving average, exceeds its slow moving average by a margin, as in
+    // Glucose. Also known as focused mode.
+    kGlucose,
+    // Restarts from level 0 after a number of conflicts following the
+    // reluctant doubling sequence in larger units than kLuby, and decides
+    // variables with their target phases, i.e. those of the longest trail
+    // since the last restart. Also known as stable mode.
+    kStable,
+    // Switches between kGlucose and kStable, spending 1000, 1000, 2000, 2000,
+    // 4000... conflicts in each mode in turn, starting with kGlucose.
+    kSwitching,
+  };
+
+  // Counters of the search, kept from one call to the next.
+  struct Stats {
+    int64_t decisions = 0;
+    int64_t conflicts = 0;
+    int64_t propagations = 0;
+    int64_t restarts = 0;
+    // Switches between focused and stable modes.
+    int64_t switches = 0;
+    int64_t learnedClauses = 0;
+    int64_t clauseLength = 0;
+    int64_t purged = 0;
+    int64_t rephases = 0;
+    // Flips of local search when rephasing.
+    int64_t flips = 0;
+
+    std::string ToString() const;
+  };
+
+  // A learned clause along with its LBD.
+  using SharedClause = std::pair<Clause, uint32_t>;
+  // Function given every clause learned.
+  using ExportFn = std::function<void(const Clause &, uint32_t lbd)>;
+  // Function appending the clauses learned elsewhere since it was last called.
+  using ImportFn = std::function<void(std::vector<SharedClause> &)>;
+
+  C();
+  ~C() override;
+
+  void Reset() override;
   std::pair<Result, Assignment> Solve() override;
   std::pair<Result, std::vector<Assignment>> SolveAll() override;
   std::string ID() const override { return "C"; }
+
+  // Lists the models of the instance projected onto its non-temporary
+  // variables, i.e. every assignment of those that can be extended to a
+  // satisfying assignment, each handed over once. After each model, a clause
+  // blocking it is learned, made of its non-temporary literals not implied by
+  // the others, and the search goes on with the clauses learned so far. Those
+  // clauses are dropped once done, so later calls solve the original instance.
+  Result SolveAll(const ModelFn &) override;
+
+  // Solves the instance assuming the given literals are true. Clauses can be
+  // added between calls, and learned clauses, activities and saved phases are
+  // kept from one call to the next.
+  std::pair<Result, Assignment> Solve(const std::vector<Lit> &assumptions);
+
+  // Subset of the assumptions of the last call to Solve that was enough to
+  // make the instance unsatisfiable. It's empty if the instance is
+  // unsatisfiable regardless of the assumptions.
+  const std::vector<Lit> &Failed() const { return failed_; }
+
+  // Counters of the search since the last Reset.
+  Stats GetStats() const;
+
+  // Sets the maximum size in bytes of the clause database. Exceeding it
+  // triggers a reduction of the learned clauses. Zero means no limit.
+  void SetMemoryLimit(size_t bytes) { memoryLimit_ = bytes; }
+
+  // Sets whether SolveAll backtracks after each model only as far as needed
+  // for its blocking clause to be unit, rather than restarting from level 0.
+  void SetBacktrackOnModels(bool backtrack) { backtrack_ = backtrack; }
+
+  // Seeds the random choices of the search, which are seeded from the system
+  // otherwise.
+  void SetSeed(uint32_t seed);
+
+  // Sets the initial phase of variables not yet decided.
+  void SetPhase(Phase phase) { phase_ = phase; }
+
+  void SetRestarts(Restarts restarts) { restarts_ = restarts; }
+
+  // Sets whether the saved phases are reset every so many conflicts, with
+  // increasing intervals. They're reset in turn to the best assignment found
+  // by a bounded walk of local search from the saved phases, the phases of the
+  // longest trail reached since the previous reset, and more rarely the
+  // initial phases or their inverses. It's off by default, as it slows down
+  // some unsatisfiable instances, and never done while listing models.
+  void SetRephasing(bool rephase) { rephase_ = rephase; }
+
+  // Sets functions sharing learned clauses with solvers working on the same
+  // clauses, e.g. on other threads. Every clause learned by Solve is handed to
+  // exportFn, while importFn is polled every so many conflicts for clauses
+  // learned elsewhere. Those are added at level 0, restarting the search if
+  // there are any.
+  void SetClauseSharing(ExportFn exportFn, ImportFn importFn) {
+    exportFn_ = std::move(exportFn);
+    importFn_ = std::move(importFn);
+  }
+
+private:
+  struct State;
+
+  size_t memoryLimit_;
+  bool backtrack_;
+  bool seeded_;
+  uint32_t seed_;
+  Phase phase_;
+  Restarts restarts_;
+  bool rephase_;
+  ExportFn exportFn_;
+  ImportFn importFn_;
+  std::vector<Lit> failed_;
+  std::unique_ptr<State> state_;
+
+  // Solves the instance under the given assumptions, handing every projected
+  // model to onModel instead of returning the first one if given.
+  std::pair<Result, Assignment> Search(const std::vector<Lit> &assumptions,
+                                       const ModelFn *onModel);
 };
 
+// Copies the instance over variables 1..numVars made of the given clauses into
+// an empty Algorithm C solver, e.g. for another algorithm to hand it over.
+void CopyTo(int numVars, const ClauseArena &clauses, C &to);
+
 } // namespace algorithm
 } // namespace solver
@@ -0,0 +1,557 @@
+#include "solver/algorithm/counter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <sstream>
+#include <unordered_map>
+
+#include "solver/algorithm/c.h"
+#include "util/log.h"
+
+namespace solver {
+namespace algorithm {
+
+namespace {
+
+constexpr CRef kNullRef = ClauseArena::kNullRef;
+
+// Activity scores are halved after this many conflicts, so that the decision
+// heuristic favors variables of recent conflicts.
+constexpr int64_t kDecayPeriod = 256;
+
+// Minimum number of learned clauses kept before reducing them, and growth
+// factor of the limit after each reduction.
+constexpr size_t kMinLearned = 10000;
+constexpr double kLearnedGrowth = 1.1;
+
+// Estimated bytes used by each cache entry besides its key and count.
+constexpr size_t kEntryOverhead = 64;
+
+struct Stats {
+  int64_t decisions = 0;
+  int64_t conflicts = 0;
+  int64_t propagations = 0;
+  int64_t components = 0;
+  int64_t cacheHits = 0;
+  int64_t dropped = 0;
+  int64_t learnedClauses = 0;
+  int64_t purged = 0;
+
+  std::string ToString() const {
+    std::stringstream out;
+    out << "decisions=" << decisions << " conflicts=" << conflicts
+        << " propagations=" << propagations << " components=" << components
+        << " cacheHits=" << cacheHits << " dropped=" << dropped
+        << " learned=" << learnedClauses << " purged=" << purged;
+    return out.str();
+  }
+};
+
+// A component of the formula left by the current assignment: its unassigned
+// variables, in increasing order, the original clauses connecting them, not
+// yet satisfied, and the variable to branch on.
+struct Component {
+  std::vector<int> vars;
+  std::vector<CRef> clauses;
+  int decision = 0;
+};
+
+struct KeyHash {
+  size_t operator()(const std::vector<uint32_t> &key) const {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (const uint32_t k : key) {
+      h = (h ^ k) * 0x100000001b3ULL;
+    }
+    return static_cast<size_t>(h ^ (h >> 32));
+  }
+};
+
+} // namespace
+
+struct Counter::Search {
+  Counter &s;
+  Stats stats;
+  bool interrupted = false;
+
+  // Original clauses, without repeated literals nor tautologies, followed by
+  // the learned clauses. Each clause watches c[0] and c[1], and the literal
+  // forced by a reason clause is c[0].
+  ClauseArena clauses;
+  // Number of references of original clauses, which come first and never
+  // move.
+  size_t numOriginal = 0;
+  // watches[l] = clauses watching literal l, visited when l becomes false.
+  std::vector<std::vector<CRef>> watches;
+  // occ[x] = original clauses containing x or ¬x.
+  std::vector<std::vector<CRef>> occ;
+  size_t maxLearned = kMinLearned;
+
+  // val[l] = 1 if literal l is true, -1 if false and 0 if unassigned.
+  std::vector<int8_t> val;
+  std::vector<int> level;
+  std::vector<CRef> reason;
+  std::vector<int> trail;
+  // lloc[d] = position in the trail of the decision at level d+1.
+  std::vector<size_t> lloc;
+  size_t qhead = 0;
+
+  // Branching scores: activity from conflicts and occurrences in the
+  // component being split.
+  std::vector<double> act;
+  std::vector<int> deg;
+
+  // Stamps for splitting components, per variable and per original clause,
+  // the latter indexed by reference.
+  uint32_t latestStamp = 0;
+  std::vector<uint32_t> varStamp;
+  std::vector<uint32_t> clauseStamp;
+
+  // Scratch space for conflict analysis.
+  std::vector<bool> seen;
+  std::vector<Lit> b;
+  std::vector<Lit> analyzed;
+
+  // cache[key] = count of the component described by key: the number of its
+  // variables, the variables and the references of its clauses.
+  std::unordered_map<std::vector<uint32_t>, util::BigUint, KeyHash> cache;
+  // Keys of the entries in the order they were cached, so that those cached
+  // since a given point can be dropped.
+  std::vector<const std::vector<uint32_t> *> cached;
+  size_t cacheBytes = 0;
+
+  explicit Search(Counter &s);
+
+  std::pair<Result, util::BigUint> Run();
+
+  int D() const { return static_cast<int>(lloc.size()); }
+  bool IsFree(int x) const { return val[2 * x] == 0; }
+  void Assign(int l, CRef r);
+  void Backtrack(int d);
+  // Propagates the assignments not yet propagated. Returns the reference of a
+  // falsified clause, or kNullRef.
+  CRef Propagate();
+  void Learn(CRef conflict);
+  void Reduce();
+
+  // Splits the free variables among vars into components and returns the
+  // product of their counts. The free variables in no clause count twice.
+  util::BigUint CountComponents(const std::vector<int> &vars);
+  util::BigUint CountComponent(const Component &);
+};
+
+Counter::Search::Search(Counter &s) : s(s) {
+  const int n = s.NumVars();
+  watches.resize(2 * n + 2);
+  occ.resize(n + 1);
+  val.assign(2 * n + 2, 0);
+  level.assign(n + 1, -1);
+  reason.assign(n + 1, kNullRef);
+  act.assign(n + 1, 0);
+  deg.assign(n + 1, 0);
+  varStamp.assign(n + 1, 0);
+  seen.assign(n + 1, false);
+}
+
+void Counter::Search::Assign(int l, CRef r) {
+  const int x = l >> 1;
+  val[l] = 1;
+  val[l ^ 1] = -1;
+  level[x] = D();
+  reason[x] = r;
+  trail.push_back(l);
+}
+
+void Counter::Search::Backtrack(int d) {
+  if (D() <= d) {
+    return;
+  }
+  while (trail.size() > lloc[d]) {
+    const int l = trail.back();
+    val[l] = 0;
+    val[l ^ 1] = 0;
+    level[l >> 1] = -1;
+    reason[l >> 1] = kNullRef;
+    trail.pop_back();
+  }
+  lloc.resize(d);
+  qhead = trail.size();
+}
+
+CRef Counter::Search::Propagate() {
+  while (qhead < trail.size()) {
+    const int f = trail[qhead++] ^ 1;
+    auto &ws = watches[f];
+    size_t i = 0;
+    size_t j = 0;
+    while (i < ws.size()) {
+      const CRef cr = ws[i++];
+      auto c = clauses[cr];
+      if (c[0].ID() == f) {
+        std::swap(c[0], c[1]);
+      }
+      if (val[c[0].ID()] == 1) {
+        ws[j++] = cr;
+        continue;
+      }
+      bool moved = false;
+      for (size_t k = 2; k < c.size(); ++k) {
+        if (val[c[k].ID()] != -1) {
+          std::swap(c[1], c[k]);
+          watches[c[1].ID()].push_back(cr);
+          moved = true;
+          break;
+        }
+      }
+      if (moved) {
+        continue;
+      }
+      ws[j++] = cr;
+      if (val[c[0].ID()] == -1) {
+        while (i < ws.size()) {
+          ws[j++] = ws[i++];
+        }
+        ws.resize(j);
+        qhead = trail.size();
+        return cr;
+      }
+      Assign(c[0].ID(), cr);
+      ++stats.propagations;
+    }
+    ws.resize(j);
+  }
+  return kNullRef;
+}
+
+// Learns the first UIP clause of the conflict, with its literals implied by
+// the others removed.
+// @see: 7.2.2.2 - Algorithm C, step C7, p68
+void Counter::Search::Learn(CRef conflict) {
+  ++stats.conflicts;
+  if (stats.conflicts % kDecayPeriod == 0) {
+    for (auto &a : act) {
+      a /= 2;
+    }
+  }
+
+  // b[0] is set to the negation of the UIP at the end.
+  b.assign(1, clauses[conflict][0]);
+  int pending = 0;
+  int p = -1;
+  size_t t = trail.size();
+  CRef cr = conflict;
+  do {
+    const auto c = clauses[cr];
+    // The first literal of a reason clause is the one it forced.
+    for (size_t k = p == -1 ? 0 : 1; k < c.size(); ++k) {
+      const int x = c[k].VID();
+      if (seen[x] || level[x] == 0) {
+        continue;
+      }
+      seen[x] = true;
+      act[x] += 1;
+      if (level[x] == D()) {
+        ++pending;
+      } else {
+        b.push_back(c[k]);
+      }
+    }
+    do {
+      --t;
+    } while (!seen[trail[t] >> 1]);
+    p = trail[t];
+    cr = reason[p >> 1];
+    seen[p >> 1] = false;
+    --pending;
+  } while (pending > 0);
+  b[0] = ~Lit(p);
+
+  // A literal is redundant if the rest of its reason is in the clause.
+  analyzed.assign(b.begin() + 1, b.end());
+  size_t j = 1;
+  for (size_t i = 1; i < b.size(); ++i) {
+    const CRef r = reason[b[i].VID()];
+    bool redundant = r != kNullRef;
+    if (redundant) {
+      const auto c = clauses[r];
+      for (size_t k = 1; k < c.size() && redundant; ++k) {
+        redundant = seen[c[k].VID()] || level[c[k].VID()] == 0;
+      }
+    }
+    if (!redundant) {
+      b[j++] = b[i];
+    }
+  }
+  b.erase(b.begin() + j, b.end());
+  for (const auto &lit : analyzed) {
+    seen[lit.VID()] = false;
+  }
+
+  // Unit clauses would need to be asserted at level 0, in the middle of the
+  // components split from it, so they're not kept.
+  if (b.size() < 2) {
+    return;
+  }
+  // Watch a literal of the highest level below the current one, which is the
+  // last to become unassigned.
+  for (size_t i = 2; i < b.size(); ++i) {
+    if (level[b[i].VID()] > level[b[1].VID()]) {
+      std::swap(b[1], b[i]);
+    }
+  }
+  const CRef lc = clauses.Alloc(b.data(), b.size(), true);
+  watches[b[0].ID()].push_back(lc);
+  watches[b[1].ID()].push_back(lc);
+  ++stats.learnedClauses;
+}
+
+// Frees the longest half of the learned clauses not acting as reasons.
+void Counter::Search::Reduce() {
+  const auto &refs = clauses.Refs();
+  std::vector<std::pair<size_t, CRef>> candidates;
+  for (size_t i = numOriginal; i < refs.size(); ++i) {
+    const auto c = clauses[refs[i]];
+    if (c.Header().deleted) {
+      continue;
+    }
+    const int x = c[0].VID();
+    if (val[c[0].ID()] == 1 && reason[x] == refs[i]) {
+      continue;
+    }
+    candidates.emplace_back(c.size(), refs[i]);
+  }
+  std::sort(candidates.begin(), candidates.end(), std::greater<>());
+  for (size_t i = 0; i < candidates.size() / 2; ++i) {
+    clauses.Free(candidates[i].second);
+    ++stats.purged;
+  }
+  clauses.Compact([&](CRef from, CRef to) {
+    const int x = clauses[to][0].VID();
+    if (reason[x] == from) {
+      reason[x] = to;
+    }
+  });
+  for (auto &ws : watches) {
+    ws.clear();
+  }
+  for (auto it = clauses.begin(); it != clauses.end(); ++it) {
+    const auto c = *it;
+    watches[c[0].ID()].push_back(it.Ref());
+    watches[c[1].ID()].push_back(it.Ref());
+  }
+  maxLearned = static_cast<size_t>(maxLearned * kLearnedGrowth);
+}
+
+util::BigUint Counter::Search::CountComponents(const std::vector<int> &vars) {
+  // Split the components by a breadth-first search over the clauses not yet
+  // satisfied.
+  ++latestStamp;
+  std::vector<Component> components;
+  size_t freeVars = 0;
+  std::vector<int> queue;
+  for (const int x : vars) {
+    if (!IsFree(x) || varStamp[x] == latestStamp) {
+      continue;
+    }
+    Component comp;
+    queue.assign(1, x);
+    varStamp[x] = latestStamp;
+    for (size_t i = 0; i < queue.size(); ++i) {
+      for (const CRef cr : occ[queue[i]]) {
+        if (clauseStamp[cr] == latestStamp) {
+          continue;
+        }
+        clauseStamp[cr] = latestStamp;
+        const auto c = clauses[cr];
+        if (std::any_of(c.begin(), c.end(),
+                        [&](const Lit &lit) { return val[lit.ID()] == 1; })) {
+          continue;
+        }
+        comp.clauses.push_back(cr);
+        for (const auto &lit : c) {
+          const int y = lit.VID();
+          if (IsFree(y)) {
+            ++deg[y];
+            if (varStamp[y] != latestStamp) {
+              varStamp[y] = latestStamp;
+              queue.push_back(y);
+            }
+          }
+        }
+      }
+    }
+    if (comp.clauses.empty()) {
+      ++freeVars;
+      continue;
+    }
+    comp.vars = queue;
+    std::sort(comp.vars.begin(), comp.vars.end());
+    std::sort(comp.clauses.begin(), comp.clauses.end());
+    double best = -1;
+    for (const int y : comp.vars) {
+      if (act[y] + deg[y] > best) {
+        best = act[y] + deg[y];
+        comp.decision = y;
+      }
+      deg[y] = 0;
+    }
+    components.push_back(std::move(comp));
+  }
+  stats.components += static_cast<int64_t>(components.size());
+
+  // Small components are counted first, as they're cheaper to refute.
+  std::sort(components.begin(), components.end(),
+            [](const Component &a, const Component &b) {
+              return a.clauses.size() < b.clauses.size();
+            });
+  const size_t mark = cached.size();
+  util::BigUint total(1);
+  for (const auto &comp : components) {
+    auto count = CountComponent(comp);
+    if (interrupted) {
+      return util::BigUint();
+    }
+    if (count.IsZero()) {
+      // The counts cached since the split may rely on clauses learned from
+      // this component, and not be implied by their own.
+      while (cached.size() > mark) {
+        const auto it = cache.find(*cached.back());
+        cacheBytes -= it->first.size() * sizeof(uint32_t) +
+                      it->second.Bytes() + kEntryOverhead;
+        cache.erase(it);
+        cached.pop_back();
+        ++stats.dropped;
+      }
+      return util::BigUint();
+    }
+    total *= count;
+  }
+  total <<= freeVars;
+  return total;
+}
+
+util::BigUint Counter::Search::CountComponent(const Component &comp) {
+  std::vector<uint32_t> key;
+  key.reserve(1 + comp.vars.size() + comp.clauses.size());
+  key.push_back(static_cast<uint32_t>(comp.vars.size()));
+  key.insert(key.end(), comp.vars.begin(), comp.vars.end());
+  key.insert(key.end(), comp.clauses.begin(), comp.clauses.end());
+  if (const auto it = cache.find(key); it != cache.end()) {
+    ++stats.cacheHits;
+    return it->second;
+  }
+  if (s.Interrupted(stats.conflicts, stats.propagations)) {
+    interrupted = true;
+    return util::BigUint();
+  }
+
+  // Add up the counts of both values of the decision variable.
+  util::BigUint total;
+  const int d = D();
+  for (const int l : {2 * comp.decision, 2 * comp.decision + 1}) {
+    ++stats.decisions;
+    lloc.push_back(trail.size());
+    Assign(l, kNullRef);
+    const CRef conflict = Propagate();
+    if (conflict == kNullRef) {
+      total += CountComponents(comp.vars);
+    } else {
+      Learn(conflict);
+    }
+    Backtrack(d);
+    if (interrupted) {
+      return util::BigUint();
+    }
+  }
+  if (clauses.Refs().size() - numOriginal > maxLearned) {
+    Reduce();
+  }
+
+  const size_t bytes =
+      key.size() * sizeof(uint32_t) + total.Bytes() + kEntryOverhead;
+  if (s.cacheLimit_ == 0 || cacheBytes + bytes <= s.cacheLimit_) {
+    const auto [it, inserted] = cache.emplace(std::move(key), total);
+    if (inserted) {
+      cached.push_back(&it->first);
+      cacheBytes += bytes;
+    }
+  }
+  return total;
+}
+
+std::pair<Result, util::BigUint> Counter::Search::Run() {
+  // Compile the original clauses, assigning units at level 0.
+  std::vector<int> units;
+  Clause c;
+  for (const auto clause : s.clauses_) {
+    c.assign(clause.begin(), clause.end());
+    if (!Normalize(c)) {
+      continue;
+    }
+    if (c.empty()) {
+      return {Result::kUNSAT, util::BigUint()};
+    }
+    if (c.size() == 1) {
+      units.push_back(c[0].ID());
+      continue;
+    }
+    const CRef cr = clauses.Alloc(c.data(), c.size());
+    watches[c[0].ID()].push_back(cr);
+    watches[c[1].ID()].push_back(cr);
+    for (const auto &lit : c) {
+      occ[lit.VID()].push_back(cr);
+    }
+  }
+  numOriginal = clauses.Refs().size();
+  clauseStamp.assign(clauses.Words(), 0);
+  maxLearned = std::max(kMinLearned, numOriginal / 2);
+
+  for (const int l : units) {
+    if (val[l] == -1) {
+      return {Result::kUNSAT, util::BigUint()};
+    }
+    if (val[l] == 0) {
+      Assign(l, kNullRef);
+    }
+  }
+  if (Propagate() != kNullRef) {
+    return {Result::kUNSAT, util::BigUint()};
+  }
+
+  std::vector<int> vars(s.NumVars());
+  for (int x = 1; x <= s.NumVars(); ++x) {
+    vars[x - 1] = x;
+  }
+  auto count = CountComponents(vars);
+  LOG << "stats: " << stats.ToString() << " cached=" << cache.size();
+  if (interrupted) {
+    return {Result::kUnknown, util::BigUint()};
+  }
+  return {count.IsZero() ? Result::kUNSAT : Result::kSAT, count};
+}
+
+std::pair<Result, util::BigUint> Counter::Count() {
+  StartSearch();
+  Search search(*this);
+  return search.Run();
+}
+
+std::pair<Result, Assignment> Counter::Solve() {
+  const auto [res, count] = Count();
+  if (res != Result::kSAT) {
+    return {res, {}};
+  }
+  COMMENT << "model count: " << count;
+  C c;
+  CopyTo(NumVars(), clauses_, c);
+  return c.Solve();
+}
+
+std::pair<Result, std::vector<Assignment>> Counter::SolveAll() {
+  C c;
+  CopyTo(NumVars(), clauses_, c);
+  return c.SolveAll();
+}
+
+} // namespace algorithm
+} // namespace solver
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "solver/solver.h"
+#include "util/big_uint.h"
+
+namespace solver {
+namespace algorithm {
+
+/*
+ * Exact model counter (#SAT), in the spirit of Cachet and sharpSAT.
+ *
+ * A DPLL search that splits the formula left by each assignment into connected
+ * components, which share no variables and are counted independently, and
+ * multiplies their counts. The count of each component is cached, keyed by its
+ * variables and the original clauses it's made of, which determine it
+ * uniquely. Conflicts are analyzed as in Algorithm C, and the clauses learned
+ * prune the search without affecting the counts.
+ *
+ * A learned clause only follows from the whole instance, so a component may be
+ * undercounted while a sibling component is unsatisfiable. The count of the
+ * branch is zero regardless, and every count cached since the siblings were
+ * split is dropped from the cache, which keeps it exact.
+ *
+ * @see: T. Sang, F. Bacchus, P. Beame, H. Kautz and T. Pitassi, Combining
+ *       component caching and clause learning for effective model counting,
+ *       SAT 2004.
+ * @see: M. Thurley, sharpSAT - counting models with advanced component caching
+ *       and implicit BCP, SAT 2006.
+ */
+class Counter : public Solver {
+public:
+  Counter() : cacheLimit_(0) {}
+
+  // Counts the satisfying assignments of every variable, temporary ones
+  // included. Returns kSAT or kUNSAT along with the count if it's positive or
+  // zero, respectively, or kUnknown if the search was interrupted.
+  std::pair<Result, util::BigUint> Count();
+
+  // Counts the models and logs the count, then finds one with Algorithm C.
+  std::pair<Result, Assignment> Solve() override;
+  // Lists the models with Algorithm C.
+  std::pair<Result, std::vector<Assignment>> SolveAll() override;
+  std::string ID() const override { return "#"; }
+
+  // Sets the maximum size in bytes of the component cache, beyond which no
+  // more counts are cached. Zero means no limit.
+  void SetCacheLimit(size_t bytes) { cacheLimit_ = bytes; }
+
+private:
+  struct Search;
+
+  size_t cacheLimit_;
+};
+
+} // namespace algorithm
+} // namespace solver
@@ -0,0 +1,386 @@
+#include "solver/algorithm/cube.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "solver/algorithm/c.h"
+#include "solver/algorithm/lookahead.h"
+#include "solver/algorithm/race.h"
+#include "util/log.h"
+#include "util/work_stealing_pool.h"
+
+namespace solver {
+namespace algorithm {
+
+namespace {
+
+// Log2 of the number of cubes per thread, so that threads finishing early
+// still find cubes to take from the others.
+constexpr int kCubeBitsPerThread = 5;
+
+// Number of variables looked ahead at each node, preselected by how much
+// their literals occur in unsatisfied clauses.
+constexpr size_t kCandidates = 32;
+
+// Lookahead over the clauses, which keeps for each of them the number of its
+// literals true and false so far, so that it's cheap to tell how much the
+// propagation of a literal reduced them.
+class Lookahead {
+public:
+  // Checks the budget given the number of propagations so far.
+  using InterruptFn = std::function<bool(int64_t)>;
+
+  Lookahead(int n, const ClauseArena &clauses, InterruptFn interrupted);
+
+  // Appends the cubes of up to depth decisions splitting the clauses to out.
+  // Returns whether splitting was interrupted.
+  bool Split(int depth, std::vector<CubeAndConquer::Cube> &out);
+
+private:
+  std::vector<Clause> clauses_;
+  // occ_[l] = indices of the clauses with literal l.
+  std::vector<std::vector<int>> occ_;
+  std::vector<int> numTrue_;
+  std::vector<int> numFalse_;
+  int numSatisfied_;
+  // val_[x] = 1 if x is true, -1 if false, 0 if free.
+  std::vector<int8_t> val_;
+  std::vector<Lit> trail_;
+  // Literals of the trail before this have been propagated.
+  size_t head_;
+  // Weight of the clauses reduced since last reset.
+  double reduced_;
+  int64_t propagations_;
+  InterruptFn interrupted_;
+  bool stopped_;
+
+  bool IsFree(Lit l) const { return val_[l.VID()] == 0; }
+  bool IsTrue(Lit l) const { return val_[l.VID()] == (l.IsPos() ? 1 : -1); }
+  bool IsFalse(Lit l) const { return val_[l.VID()] == (l.IsPos() ? -1 : 1); }
+
+  void Assign(Lit l) {
+    val_[l.VID()] = l.IsPos() ? 1 : -1;
+    trail_.push_back(l);
+  }
+  // Propagates the literals of the trail not yet propagated. Returns false on
+  // a conflict.
+  bool Propagate();
+  // Unassigns the literals of the trail after the first mark ones.
+  void Undo(size_t mark);
+  // Variables to look ahead, best first.
+  std::vector<Var> Preselect() const;
+  // Splits the node of the search tree for the given cube.
+  void Node(int depth, CubeAndConquer::Cube &,
+            std::vector<CubeAndConquer::Cube> &out);
+};
+
+Lookahead::Lookahead(int n, const ClauseArena &clauses,
+                     InterruptFn interrupted)
+    : occ_(2 * n + 2), numSatisfied_(0), val_(n + 1, 0), head_(0),
+      reduced_(0), propagations_(0), interrupted_(std::move(interrupted)),
+      stopped_(false) {
+  Clause clause;
+  for (const auto c : clauses) {
+    clause.assign(c.begin(), c.end());
+    if (!Normalize(clause)) {
+      continue;
+    }
+    for (const Lit l : clause) {
+      occ_[l.ID()].push_back(static_cast<int>(clauses_.size()));
+    }
+    clauses_.push_back(clause);
+  }
+  numTrue_.assign(clauses_.size(), 0);
+  numFalse_.assign(clauses_.size(), 0);
+}
+
+bool Lookahead::Propagate() {
+  while (head_ < trail_.size()) {
+    const Lit l = trail_[head_++];
+    ++propagations_;
+    for (const int c : occ_[l.ID()]) {
+      if (numTrue_[c]++ == 0) {
+        ++numSatisfied_;
+      }
+    }
+    const auto &reduced = occ_[(~l).ID()];
+    for (const int c : reduced) {
+      ++numFalse_[c];
+    }
+    // Every literal of the trail counted so far is fully counted, so that
+    // Undo can uncount it even if this returns early.
+    for (const int c : reduced) {
+      if (numTrue_[c] > 0) {
+        continue;
+      }
+      const int k = static_cast<int>(clauses_[c].size()) - numFalse_[c];
+      if (k > 1) {
+        reduced_ += ReducedWeight(k);
+        continue;
+      }
+      // Literals of the trail not propagated yet aren't counted, so check
+      // the values of the clause itself.
+      int numFree = 0;
+      Lit unit = l;
+      bool satisfied = false;
+      for (const Lit u : clauses_[c]) {
+        if (IsTrue(u)) {
+          satisfied = true;
+          break;
+        }
+        if (IsFree(u)) {
+          unit = u;
+          ++numFree;
+        }
+      }
+      if (satisfied) {
+        continue;
+      }
+      if (numFree == 0) {
+        return false;
+      }
+      Assign(unit);
+    }
+  }
+  return true;
+}
+
+void Lookahead::Undo(size_t mark) {
+  while (trail_.size() > mark) {
+    const Lit l = trail_.back();
+    trail_.pop_back();
+    if (trail_.size() < head_) {
+      for (const int c : occ_[l.ID()]) {
+        if (--numTrue_[c] == 0) {
+          --numSatisfied_;
+        }
+      }
+      for (const int c : occ_[(~l).ID()]) {
+        --numFalse_[c];
+      }
+    }
+    val_[l.VID()] = 0;
+  }
+  head_ = std::min(head_, mark);
+}
+
+std::vector<Var> Lookahead::Preselect() const {
+  // score[l] = weight of the unsatisfied clauses with literal l.
+  std::vector<double> score(occ_.size(), 0);
+  for (size_t c = 0; c < clauses_.size(); ++c) {
+    if (numTrue_[c] > 0) {
+      continue;
+    }
+    const int k = static_cast<int>(clauses_[c].size()) - numFalse_[c];
+    for (const Lit l : clauses_[c]) {
+      if (IsFree(l)) {
+        score[l.ID()] += ReducedWeight(k);
+      }
+    }
+  }
+  std::vector<std::pair<double, int>> vars;
+  for (int x = 1; x < static_cast<int>(val_.size()); ++x) {
+    const double pos = score[2 * x];
+    const double neg = score[2 * x + 1];
+    if (val_[x] == 0 && pos + neg > 0) {
+      vars.emplace_back(-(pos * neg + pos + neg), x);
+    }
+  }
+  const size_t n = std::min(vars.size(), kCandidates);
+  std::partial_sort(vars.begin(), vars.begin() + n, vars.end());
+  std::vector<Var> candidates;
+  for (size_t i = 0; i < n; ++i) {
+    candidates.emplace_back(vars[i].second);
+  }
+  return candidates;
+}
+
+void Lookahead::Node(int depth, CubeAndConquer::Cube &cube,
+                     std::vector<CubeAndConquer::Cube> &out) {
+  const size_t entry = trail_.size();
+  if (!stopped_ && interrupted_(propagations_)) {
+    stopped_ = true;
+  }
+  if (stopped_ || depth == 0) {
+    out.push_back(cube);
+    return;
+  }
+
+  // Looks ahead on both literals of each candidate, setting failed literals to
+  // the opposite value, until there are no more failed literals.
+  Lit best = Lit(Var(1));
+  double bestScore = -1;
+  double bestReduced[2] = {0, 0};
+  for (bool failed = true; failed;) {
+    failed = false;
+    bestScore = -1;
+    if (numSatisfied_ == static_cast<int>(clauses_.size())) {
+      break;
+    }
+    for (const Var x : Preselect()) {
+      if (!IsFree(x)) {
+        continue;
+      }
+      double reduced[2];
+      for (int s = 0; s < 2 && IsFree(x); ++s) {
+        const Lit l = s == 0 ? Lit(x) : ~x;
+        const size_t mark = trail_.size();
+        reduced_ = 0;
+        Assign(l);
+        const bool ok = Propagate();
+        reduced[s] = reduced_;
+        Undo(mark);
+        if (!ok) {
+          failed = true;
+          Assign(~l);
+          if (!Propagate()) {
+            Undo(entry);
+            return;
+          }
+        }
+      }
+      if (failed) {
+        continue;
+      }
+      const double score = 1024 * reduced[0] * reduced[1] + reduced[0] +
+                           reduced[1];
+      if (score > bestScore) {
+        best = x;
+        bestScore = score;
+        bestReduced[0] = reduced[0];
+        bestReduced[1] = reduced[1];
+      }
+    }
+  }
+  if (bestScore < 0) {
+    // Every clause is satisfied.
+    out.push_back(cube);
+    Undo(entry);
+    return;
+  }
+
+  // Goes first for the literal reducing less, likelier to be satisfiable.
+  const size_t mark = trail_.size();
+  const Lit first = bestReduced[0] <= bestReduced[1] ? best : ~best;
+  for (const Lit l : {first, ~first}) {
+    Assign(l);
+    if (Propagate()) {
+      cube.push_back(l);
+      Node(depth - 1, cube, out);
+      cube.pop_back();
+    }
+    Undo(mark);
+  }
+  Undo(entry);
+}
+
+bool Lookahead::Split(int depth, std::vector<CubeAndConquer::Cube> &out) {
+  for (const auto &c : clauses_) {
+    if (c.empty() || (c.size() == 1 && IsFalse(c[0]))) {
+      return false;
+    }
+    if (c.size() == 1 && IsFree(c[0])) {
+      Assign(c[0]);
+    }
+  }
+  if (Propagate()) {
+    CubeAndConquer::Cube cube;
+    Node(depth, cube, out);
+  }
+  Undo(0);
+  return stopped_;
+}
+
+} // namespace
+
+std::vector<CubeAndConquer::Cube> CubeAndConquer::Split() {
+  bool interrupted;
+  return Split(interrupted);
+}
+
+std::vector<CubeAndConquer::Cube> CubeAndConquer::Split(bool &interrupted) {
+  StartSearch();
+  int depth = depth_;
+  if (depth <= 0) {
+    const int numThreads = Race::NumThreads(numThreads_);
+    for (depth = kCubeBitsPerThread;
+         (1 << (depth - kCubeBitsPerThread)) < numThreads; ++depth) {
+    }
+  }
+  Lookahead lookahead(NumVars(), clauses_, [this](int64_t propagations) {
+    return Interrupted(0, propagations);
+  });
+  std::vector<Cube> cubes;
+  interrupted = lookahead.Split(depth, cubes);
+  LOG << "split into " << cubes.size() << " cubes of depth up to " << depth;
+  return cubes;
+}
+
+std::pair<Result, Assignment> CubeAndConquer::Solve() {
+  bool interrupted = false;
+  const auto cubes = Split(interrupted);
+  if (interrupted) {
+    return {Result::kUnknown, {}};
+  }
+  if (cubes.empty()) {
+    return {Result::kUNSAT, {}};
+  }
+  const int numThreads =
+      std::min(Race::NumThreads(numThreads_), static_cast<int>(cubes.size()));
+
+  std::vector<std::unique_ptr<C>> engines;
+  Race race([this](int64_t conflicts, int64_t propagations) {
+    return Interrupted(conflicts, propagations);
+  });
+  // Guarded by race.mu.
+  bool unknown = false;
+  Result res = Result::kUNSAT;
+  Assignment sol;
+
+  for (int i = 0; i < numThreads; ++i) {
+    engines.push_back(std::make_unique<C>());
+    race.Add(*engines.back());
+    CopyTo(NumVars(), clauses_, *engines.back());
+  }
+
+  // Each engine keeps what it learned from one cube for the next.
+  util::WorkStealingPool pool(numThreads);
+  for (const auto &cube : cubes) {
+    pool.Push(0, [&](int w) {
+      if (race.Stopped()) {
+        return;
+      }
+      auto [r, s] = engines[w]->Solve(cube);
+      std::lock_guard<std::mutex> lock(race.mu);
+      race.Finish(w);
+      if (race.Stopped()) {
+        return;
+      }
+      if (r == Result::kSAT) {
+        res = r;
+        sol = std::move(s);
+        race.Stop();
+      } else if (r == Result::kUnknown) {
+        unknown = true;
+      }
+    });
+  }
+  pool.Run();
+
+  if (res != Result::kSAT && (race.Interrupted() || unknown)) {
+    return {Result::kUnknown, {}};
+  }
+  return {res, sol};
+}
+
+std::pair<Result, std::vector<Assignment>> CubeAndConquer::SolveAll() {
+  C c;
+  CopyTo(NumVars(), clauses_, c);
+  return c.SolveAll();
+}
+
+} // namespace algorithm
+} // namespace solver
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "solver/solver.h"
+
+namespace solver {
+namespace algorithm {
+
+/*
+ * Cube and conquer: a lookahead pass splits the instance into cubes, i.e.
+ * conjunctions of literals that together cover every satisfying assignment,
+ * and then a pool of threads solves the instance under each cube with its own
+ * instance of Algorithm C, keeping what it learns from one cube to the next.
+ * The first cube found satisfiable stops the others, while the instance is
+ * unsatisfiable once every cube is.
+ *
+ * The lookahead propagates both values of the most promising variables, and
+ * splits on the one whose literals reduce the most clauses, weighting shorter
+ * reduced clauses higher. Literals whose propagation fails are set to the
+ * opposite value, and branches refuted that way aren't emitted as cubes.
+ *
+ * @see: Heule et al., Cube and Conquer: Guiding CDCL SAT Solvers by
+ * Lookaheads, HVC 2011.
+ */
+class CubeAndConquer : public Solver {
+public:
+  using Cube = std::vector<Lit>;
+
+  // Runs on the given number of threads, or on as many as the hardware
+  // supports if 0. Cubes are made of up to depth decisions, or of a number
+  // growing with the threads if 0.
+  explicit CubeAndConquer(int numThreads = 0, int depth = 0)
+      : numThreads_(numThreads), depth_(depth) {}
+
+  std::pair<Result, Assignment> Solve() override;
+  // Lists the models with a single instance of Algorithm C.
+  std::pair<Result, std::vector<Assignment>> SolveAll() override;
+  std::string ID() const override { return "CC"; }
+
+  // Splits the instance into cubes, in the order the lookahead explores them.
+  // There are none if the lookahead refutes the instance. Splitting stops
+  // early, leaving larger cubes, if the search is interrupted.
+  std::vector<Cube> Split();
+
+private:
+  int numThreads_;
+  int depth_;
+
+  // Like Split, also telling whether splitting was interrupted.
+  std::vector<Cube> Split(bool &interrupted);
+};
+
+} // namespace algorithm
+} // namespace solver
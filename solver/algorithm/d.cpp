@@ -8,7 +8,8 @@
 namespace solver {
 namespace algorithm {
 
-std::pair<Result, Assignment> D::Solve() {
+// Builds the cells and the initial watch lists from the clauses.
+void D::Compile() {
   // L[i]     = i-th cell's literal.
   // W[l]     = first clause watching literal l or 0 if none.
   // START[j] = first cell of clause j
@@ -18,6 +19,37 @@ std::pair<Result, Assignment> D::Solve() {
   std::vector<int> START(NumClauses() + 1, 0);
   std::vector<int> LINK(NumClauses() + 1, 0);
 
+  // Build the clause data structure and watch lists.
+  // Literals of clause j are in the cells START[j] to START[j-1]-1.
+  for (int j = NumClauses(); j >= 1; --j) {
+    START[j] = L.size();
+    for (auto l : clauses_[clauses_.Refs()[j - 1]]) {
+      L.push_back(l.ID());
+    }
+    int l = L[START[j]]; // this clause's watchee.
+    LINK[j] = W[l];
+    W[l] = j;
+  }
+  START[0] = L.size();
+
+  layout_.L = std::move(L);
+  layout_.W = std::move(W);
+  layout_.START = std::move(START);
+  layout_.LINK = std::move(LINK);
+  layout_.revision = Revision();
+}
+
+std::pair<Result, Assignment> D::Solve() {
+  StartSearch();
+  if (layout_.revision != Revision()) {
+    Compile();
+  }
+  // The search moves watched literals around, so it works on copies.
+  std::vector<int> L = layout_.L;
+  std::vector<int> W = layout_.W;
+  const std::vector<int> &START = layout_.START;
+  std::vector<int> LINK = layout_.LINK;
+
   // Active ring of variables.
   //
   // head       = first element of the ring.
@@ -42,19 +74,6 @@ std::pair<Result, Assignment> D::Solve() {
   //   m[j] = 5: trying ~x[h[j]], forced by unit clause.
   std::vector<int> m(NumVars() + 1, 0);
 
-  // Build the clause data structure and watch lists.
-  // Literals of clause j are in the cells START[j] to START[j-1]-1.
-  for (int j = NumClauses(); j >= 1; --j) {
-    START[j] = L.size();
-    for (auto l : clauses_[j - 1]) {
-      L.push_back(l.ID());
-    }
-    int l = L[START[j]]; // this clause's watchee.
-    LINK[j] = W[l];
-    W[l] = j;
-  }
-  START[0] = L.size();
-
 D1: // Initialize.
 
   int d = 0;              // depth of implicit search tree.
@@ -62,6 +81,7 @@ D1: // Initialize.
   int f;                  // whether a literal is unit.
   int branchScore = 0;    // score used to select the best branching variable.
   int bestBranchTail = 0; // tail to the best branching variable in the ring.
+  int64_t conflicts = 0;  // number of dead ends found.
   m[0] = 0;
   head = 0;
   tail = 0;
@@ -217,6 +237,9 @@ D6: // Update watches.
   goto D2;
 
 D7: // Backtrack.
+  if (Interrupted(++conflicts)) {
+    return {Result::kUnknown, {}};
+  }
   tail = k;
   while (m[d] >= 2) {
     k = h[d];
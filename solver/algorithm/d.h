@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -18,6 +20,22 @@ public:
   std::pair<Result, Assignment> Solve() override;
   std::pair<Result, std::vector<Assignment>> SolveAll() override;
   std::string ID() const override { return "D"; }
+
+private:
+  // Arrays built from the clauses by Compile. The search works on copies of
+  // those it modifies, so they're reused by later calls until the instance
+  // changes.
+  struct Layout {
+    uint64_t revision = std::numeric_limits<uint64_t>::max();
+    std::vector<int> L;
+    std::vector<int> W;
+    std::vector<int> START;
+    std::vector<int> LINK;
+  };
+
+  Layout layout_;
+
+  void Compile();
 };
 
 } // namespace algorithm
@@ -10,12 +10,15 @@ namespace solver {
 namespace algorithm {
 
 std::pair<Result, Assignment> I0::Solve() {
+  StartSearch();
   int m; // current number of clauses.
   int d; // depth of implicit search tree.
   int i; // index of clause falsified by l.
   int j; // index of clause falsified by ~l.
   int t; // new depth to backtrack to on resolution.
 
+  int64_t conflicts = 0; // number of resolved conflicts.
+
   // Watch lists:
   //   W[l]    = first clause watching literal l or -1 if none.
   //   LINK[k] = next clause watching same literal as clause k or -1 if none.
@@ -32,11 +35,14 @@ std::pair<Result, Assignment> I0::Solve() {
 
   std::vector<Lit> Cm; // learned clause.
 
+  // cref[k] = reference of clause k in the clause arena.
+  std::vector<CRef> cref = clauses_.Refs();
+
   m = NumClauses();
 
   // Build watch lists.
   for (int k = 0; k < m; ++k) {
-    const int lk = clauses_[k][0].ID();
+    const int lk = clauses_[cref[k]][0].ID();
     LINK.push_back(W[lk]);
     W[lk] = k;
   }
@@ -51,13 +57,13 @@ std::pair<Result, Assignment> I0::Solve() {
   // Returns -1 if no clause is satisfied.
   auto FindFalsified = [&](int l) -> int {
     for (int k = W[l ^ 1]; k != -1; k = LINK[k]) {
-      CHECK(clauses_[k][0].ID() == (l ^ 1))
+      CHECK(clauses_[cref[k]][0].ID() == (l ^ 1))
           << "clause " << k << " should be watching " << ToString(Lit(l ^ 1))
-          << ", but it's watching " << ToString(clauses_[k][0]);
+          << ", but it's watching " << ToString(clauses_[cref[k]][0]);
       bool falsified = true;
       // Try to watch another literal.
-      for (int ii = 1; ii < (int)clauses_[k].size(); ++ii) {
-        const int ll = clauses_[k][ii].ID();
+      for (int ii = 1; ii < (int)clauses_[cref[k]].size(); ++ii) {
+        const int ll = clauses_[cref[k]][ii].ID();
         // If ll is not set, or it's set to a value that makes this clause true.
         if (x[ll >> 1] == -1 || x[ll >> 1] == (ll & 1)) {
           falsified = false;
@@ -75,14 +81,14 @@ std::pair<Result, Assignment> I0::Solve() {
   auto UpdateWatches =
       [&](int l) {
         for (int k = W[l ^ 1]; k != -1;) {
-          CHECK(clauses_[k][0].ID() == (l ^ 1))
+          CHECK(clauses_[cref[k]][0].ID() == (l ^ 1))
               << "clause " << k << " should be watching "
               << ToString(Lit(l ^ 1)) << ", but it's watching "
-              << ToString(clauses_[k][0]);
+              << ToString(clauses_[cref[k]][0]);
           bool found = false;
           // Try to watch another literal.
-          for (int ii = 1; ii < (int)clauses_[k].size(); ++ii) {
-            const int ll = clauses_[k][ii].ID();
+          for (int ii = 1; ii < (int)clauses_[cref[k]].size(); ++ii) {
+            const int ll = clauses_[cref[k]][ii].ID();
             // If ll is not set, or it's set to a value that makes this clause
             // true.
             if (x[ll >> 1] == -1 || x[ll >> 1] == (ll & 1)) {
@@ -91,7 +97,7 @@ std::pair<Result, Assignment> I0::Solve() {
               W[l ^ 1] = LINK[kk]; // clause k no longer watches l.
               LINK[kk] = W[ll];    // clause k now watches ll.
               W[ll] = kk;          // clause k is now the first watching ll.
-              std::swap(clauses_[kk][0], clauses_[kk][ii]);
+              std::swap(clauses_[cref[kk]][0], clauses_[cref[kk]][ii]);
               found = true;
               break;
             }
@@ -115,6 +121,9 @@ I2: // Advance.
     }
     return {Result::kSAT, sol};
   }
+  if (Interrupted(conflicts)) {
+    return {Result::kUnknown, {}};
+  }
   CHECK(!q.empty()) << "there must be unset literals available";
   ++d;
   l[d] = q.front();
@@ -130,7 +139,7 @@ I3: // Find falsified C(i).
     UpdateWatches(l[d]);
     goto I2;
   }
-  LOG << "I3: C(" << i << ") is falsified: " << ToString(clauses_[i]);
+  LOG << "I3: C(" << i << ") is falsified: " << ToString(clauses_[cref[i]]);
 
 I4: // Find falsified C(j).
   l[d] ^= 1;
@@ -142,25 +151,28 @@ I4: // Find falsified C(j).
     UpdateWatches(l[d]);
     goto I2;
   }
-  LOG << "I4: C(" << j << ") is falsified: " << ToString(clauses_[j]);
+  LOG << "I4: C(" << j << ") is falsified: " << ToString(clauses_[cref[j]]);
 
 I5: // Resolve.
+  if (Interrupted(++conflicts)) {
+    return {Result::kUnknown, {}};
+  }
   CHECK(0 <= i && i < m) << "falsified clause must be valid, got i=" << i;
   CHECK(0 <= j && j < m) << "falsified clause must be valid, got j=" << j;
-  CHECK(clauses_[i][0].ID() == l[d])
+  CHECK(clauses_[cref[i]][0].ID() == l[d])
       << "falsified clause i=" << i << " should be watching "
       << ToString(Lit(l[d])) << " but it's watching "
-      << ToString(clauses_[i][0]);
-  CHECK(clauses_[j][0].ID() == (l[d] ^ 1))
+      << ToString(clauses_[cref[i]][0]);
+  CHECK(clauses_[cref[j]][0].ID() == (l[d] ^ 1))
       << "falsified clause j=" << j << " should be watching "
       << ToString(Lit(l[d] ^ 1)) << " but it's watching "
-      << ToString(clauses_[j][0]);
+      << ToString(clauses_[cref[j]][0]);
 
   ++m;
   // Resolve C(m) = C(i) ⬦ C(j).
   Cm.clear();
-  Cm.insert(Cm.end(), clauses_[i].begin() + 1, clauses_[i].end());
-  Cm.insert(Cm.end(), clauses_[j].begin() + 1, clauses_[j].end());
+  Cm.insert(Cm.end(), clauses_[cref[i]].begin() + 1, clauses_[cref[i]].end());
+  Cm.insert(Cm.end(), clauses_[cref[j]].begin() + 1, clauses_[cref[j]].end());
   std::sort(Cm.begin(), Cm.end());
   Cm.erase(std::unique(Cm.begin(), Cm.end()), Cm.end());
   if (Cm.empty()) {
@@ -178,8 +190,8 @@ I5: // Resolve.
   }
   CHECK(t != -1) << "new depth after resolution must be valid";
   LOG << "I5: learned C(" << m - 1 << ")=(" << ToString(Cm) << ") from C(" << i
-      << ")=(" << ToString(clauses_[i]) << ") ⬦ C(" << j << ")=("
-      << ToString(clauses_[j]) << ")";
+      << ")=(" << ToString(clauses_[cref[i]]) << ") ⬦ C(" << j << ")=("
+      << ToString(clauses_[cref[j]]) << ")";
   for (int dd = t + 1; dd <= d; ++dd) {
     LOG << "I5: unset " << ToString(Lit(l[dd]).V());
     q.push(l[dd]);
@@ -196,7 +208,7 @@ I5: // Resolve.
   // Update the watchlist for the learned clause.
   LINK.push_back(W[Cm[0].ID()]);
   W[Cm[0].ID()] = m - 1;
-  clauses_.push_back(Cm);
+  cref.push_back(clauses_.Alloc(Cm.data(), Cm.size(), true));
   d = t;
   i = m - 1;
   goto I4;
@@ -0,0 +1,580 @@
+#include "solver/algorithm/l.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+
+#include "solver/algorithm/c.h"
+#include "solver/algorithm/lookahead.h"
+#include "util/log.h"
+
+namespace solver {
+namespace algorithm {
+
+namespace {
+
+// At most max(kC0, kC1/d) candidates are looked ahead at depth d.
+constexpr int kC0 = 30;
+constexpr int kC1 = 600;
+
+// Factor by which the trigger of double lookaheads decays at each node.
+constexpr double kTriggerDecay = 0.999;
+
+// Maximum number of compensation resolvents learned per lookahead.
+constexpr int kMaxResolvents = 8;
+
+struct Stats {
+  int64_t nodes = 0;
+  int64_t backtracks = 0;
+  int64_t propagations = 0;
+  int64_t lookaheads = 0;
+  int64_t failed = 0;
+  int64_t autarkies = 0;
+  int64_t necessary = 0;
+  int64_t windfalls = 0;
+  int64_t resolvents = 0;
+  int64_t doubles = 0;
+
+  std::string ToString() const {
+    std::stringstream out;
+    out << "nodes=" << nodes << " backtracks=" << backtracks
+        << " propagations=" << propagations << " lookaheads=" << lookaheads
+        << " failed=" << failed << " autarkies=" << autarkies
+        << " necessary=" << necessary << " windfalls=" << windfalls
+        << " resolvents=" << resolvents << " doubles=" << doubles;
+    return out.str();
+  }
+};
+
+// Outcome of the lookahead at a node.
+enum class Node {
+  kConflict,
+  kSatisfied,
+  kBranch,
+};
+
+} // namespace
+
+struct L::Search {
+  L &s;
+  Stats stats;
+
+  // BIMP[l] = literals implied by l through binary clauses.
+  std::vector<std::vector<Lit>> BIMP;
+  // ISTACK  = literals whose BIMP grew, along with its previous size.
+  std::vector<std::pair<Lit, size_t>> ISTACK;
+
+  // Clauses of three or more literals.
+  //
+  // KINX[l]   = clauses with literal l.
+  // CSIZE[c]  = literals of c not yet propagated false, while it's active.
+  // ACTIVE[c] = whether c is neither satisfied nor reduced to a binary clause.
+  // CLOG      = changes to CSIZE and ACTIVE, c for a decrement of CSIZE[c]
+  //             and ~c for a deactivation, to undo them on backtrack.
+  std::vector<Clause> big;
+  std::vector<std::vector<int>> KINX;
+  std::vector<int> CSIZE;
+  std::vector<char> ACTIVE;
+  std::vector<int> CLOG;
+
+  // VAL[x] = 1 if x is true, -1 if false, 0 if free.
+  std::vector<int8_t> VAL;
+  std::vector<Lit> trail;
+  // Literals of the trail before this have been propagated.
+  size_t head = 0;
+
+  // Lookahead state. A literal l is true in the current lookahead if
+  // LA[l] = stamp, and LCSIZE[c] is the number of literals of c not false in it
+  // if LCSTAMP[c] = stamp.
+  std::vector<uint64_t> LA;
+  std::vector<int> LCSIZE;
+  std::vector<uint64_t> LCSTAMP;
+  uint64_t stamp = 0;
+  // Literals set by the current lookahead, in order.
+  std::vector<Lit> implied;
+  // Literals of the current lookahead implied through longer clauses.
+  std::vector<Lit> windfalls;
+  // Weight of the clauses reduced by the current lookahead.
+  double weight = 0;
+  // Lookaheads weighing more than this are looked ahead twice.
+  double trigger = 0;
+
+  // Positions in trail, CLOG and ISTACK to backtrack to.
+  struct Mark {
+    size_t trail;
+    size_t clog;
+    size_t istack;
+  };
+
+  explicit Search(L &s) : s(s) {}
+
+  bool IsFree(Lit l) const { return VAL[l.VID()] == 0; }
+  bool IsTrue(Lit l) const { return VAL[l.VID()] == (l.IsPos() ? 1 : -1); }
+  bool IsFalse(Lit l) const { return VAL[l.VID()] == (l.IsPos() ? -1 : 1); }
+  bool IsTrueAhead(Lit l) const { return IsTrue(l) || LA[l.ID()] == stamp; }
+  bool IsFalseAhead(Lit l) const { return IsTrueAhead(~l); }
+
+  Mark GetMark() const { return {trail.size(), CLOG.size(), ISTACK.size()}; }
+
+  void Assign(Lit l) {
+    VAL[l.VID()] = l.IsPos() ? 1 : -1;
+    trail.push_back(l);
+  }
+
+  // Adds the binary clause (u ∨ v).
+  void AddBinary(Lit u, Lit v) {
+    for (const auto &[a, b] : {std::make_pair(u, v), std::make_pair(v, u)}) {
+      auto &imp = BIMP[(~a).ID()];
+      ISTACK.emplace_back(~a, imp.size());
+      imp.push_back(b);
+    }
+  }
+
+  void Deactivate(int c) {
+    ACTIVE[c] = false;
+    CLOG.push_back(~c);
+  }
+
+  void Backtrack(const Mark &m) {
+    while (trail.size() > m.trail) {
+      VAL[trail.back().VID()] = 0;
+      trail.pop_back();
+    }
+    head = std::min(head, m.trail);
+    while (CLOG.size() > m.clog) {
+      const int c = CLOG.back();
+      CLOG.pop_back();
+      if (c >= 0) {
+        ++CSIZE[c];
+      } else {
+        ACTIVE[~c] = true;
+      }
+    }
+    while (ISTACK.size() > m.istack) {
+      auto &imp = BIMP[ISTACK.back().first.ID()];
+      imp.erase(imp.begin() + ISTACK.back().second, imp.end());
+      ISTACK.pop_back();
+    }
+  }
+
+  // Propagates the literals of the trail not yet propagated. Returns false on
+  // a conflict.
+  bool Propagate() {
+    while (head < trail.size()) {
+      const Lit l = trail[head++];
+      ++stats.propagations;
+      // BIMP[l] may grow meanwhile, as longer clauses become binary.
+      for (size_t i = 0; i < BIMP[l.ID()].size(); ++i) {
+        const Lit u = BIMP[l.ID()][i];
+        if (IsFalse(u)) {
+          return false;
+        }
+        if (IsFree(u)) {
+          Assign(u);
+        }
+      }
+      for (const int c : KINX[l.ID()]) {
+        if (ACTIVE[c]) {
+          Deactivate(c);
+        }
+      }
+      for (const int c : KINX[(~l).ID()]) {
+        if (!ACTIVE[c]) {
+          continue;
+        }
+        --CSIZE[c];
+        CLOG.push_back(c);
+        if (CSIZE[c] > 2) {
+          continue;
+        }
+        // CSIZE only counts the literals falsified by propagation so far, and
+        // the others left may already be true or false.
+        Lit free[2] = {l, l};
+        int numFree = 0;
+        bool satisfied = false;
+        for (const Lit u : big[c]) {
+          if (IsTrue(u)) {
+            satisfied = true;
+            break;
+          }
+          if (IsFree(u)) {
+            free[std::min(numFree++, 1)] = u;
+          }
+        }
+        if (!satisfied && numFree == 0) {
+          return false;
+        }
+        Deactivate(c);
+        if (satisfied) {
+          continue;
+        }
+        if (numFree == 1) {
+          Assign(free[0]);
+        } else {
+          AddBinary(free[0], free[1]);
+        }
+      }
+    }
+    return true;
+  }
+
+  // Sets l true at the current level. Returns false on a conflict.
+  bool Force(Lit l) {
+    if (IsTrue(l)) {
+      return true;
+    }
+    if (IsFalse(l)) {
+      return false;
+    }
+    Assign(l);
+    return Propagate();
+  }
+
+  // Looks ahead on a free literal l, propagating it through the binary
+  // implications and the longer clauses reduced to a single literal. Returns
+  // false if it fails.
+  bool LookAhead(Lit l) {
+    ++stats.lookaheads;
+    ++stamp;
+    weight = 0;
+    implied.clear();
+    windfalls.clear();
+    LA[l.ID()] = stamp;
+    implied.push_back(l);
+    for (size_t i = 0; i < implied.size(); ++i) {
+      const Lit u = implied[i];
+      ++stats.propagations;
+      for (const Lit v : BIMP[u.ID()]) {
+        if (IsTrueAhead(v)) {
+          continue;
+        }
+        if (IsFalseAhead(v)) {
+          return false;
+        }
+        LA[v.ID()] = stamp;
+        implied.push_back(v);
+      }
+      for (const int c : KINX[(~u).ID()]) {
+        if (!ACTIVE[c]) {
+          continue;
+        }
+        if (LCSTAMP[c] != stamp) {
+          LCSTAMP[c] = stamp;
+          LCSIZE[c] = CSIZE[c];
+        }
+        const int k = --LCSIZE[c];
+        if (k > 1) {
+          weight += ReducedWeight(k);
+          continue;
+        }
+        Lit unit = u;
+        bool satisfied = false;
+        for (const Lit v : big[c]) {
+          if (IsTrueAhead(v)) {
+            satisfied = true;
+            break;
+          }
+          if (!IsFalseAhead(v)) {
+            unit = v;
+          }
+        }
+        if (satisfied) {
+          continue;
+        }
+        if (k == 0) {
+          return false;
+        }
+        LA[unit.ID()] = stamp;
+        implied.push_back(unit);
+        windfalls.push_back(unit);
+      }
+    }
+    return true;
+  }
+
+  // Free variables occurring in clauses not yet satisfied, by decreasing
+  // estimate of how much setting them either way would reduce the clauses.
+  // There are none once every clause is satisfied.
+  std::vector<Var> Preselect(int depth) const {
+    // h[l] = estimate of the clauses reduced by setting l true.
+    std::vector<double> h(BIMP.size(), 0);
+    std::vector<char> occurs(VAL.size(), false);
+    for (int x = 1; x < static_cast<int>(VAL.size()); ++x) {
+      if (VAL[x] != 0) {
+        continue;
+      }
+      for (const Lit l : {Lit(Var(x)), ~Var(x)}) {
+        for (const Lit u : BIMP[l.ID()]) {
+          if (IsFree(u)) {
+            h[l.ID()] += 1;
+            occurs[x] = true;
+          }
+        }
+        for (const int c : KINX[(~l).ID()]) {
+          if (ACTIVE[c]) {
+            h[l.ID()] += ReducedWeight(CSIZE[c] - 1);
+            occurs[x] = true;
+          }
+        }
+      }
+    }
+    std::vector<std::pair<double, int>> vars;
+    for (int x = 1; x < static_cast<int>(VAL.size()); ++x) {
+      if (occurs[x]) {
+        const double pos = 0.1 + h[2 * x];
+        const double neg = 0.1 + h[2 * x + 1];
+        vars.emplace_back(-pos * neg, x);
+      }
+    }
+    const size_t n = std::min(vars.size(),
+                              static_cast<size_t>(std::max(kC0, kC1 / depth)));
+    std::partial_sort(vars.begin(), vars.begin() + n, vars.end());
+    std::vector<Var> candidates;
+    for (size_t i = 0; i < n; ++i) {
+      candidates.emplace_back(vars[i].second);
+    }
+    return candidates;
+  }
+
+  // Looks ahead again on every candidate with l set. Every literal failing
+  // then is set false in turn, and its negation learned as implied by l.
+  // Returns false if l fails.
+  bool DoubleLookAhead(Lit l, const std::vector<Var> &candidates) {
+    ++stats.doubles;
+    const double w = weight;
+    const Mark mark = GetMark();
+    Assign(l);
+    bool ok = Propagate();
+    std::vector<Lit> learned;
+    for (const Var x : candidates) {
+      for (const Lit u : {Lit(x), ~x}) {
+        if (ok && IsFree(u) && !LookAhead(u)) {
+          learned.push_back(~u);
+          ok = Force(~u);
+        }
+      }
+    }
+    Backtrack(mark);
+    if (!ok) {
+      return false;
+    }
+    for (const Lit u : learned) {
+      AddBinary(~l, u);
+    }
+    if (learned.empty()) {
+      trigger = w;
+    }
+    return true;
+  }
+
+  // Looks ahead at the current node, setting the literals it finds forced,
+  // and picks the literal to branch on.
+  Node LookAheadNode(int depth, Lit &branch) {
+    trigger *= kTriggerDecay;
+    double bestScore = -1;
+    for (bool changed = true; changed;) {
+      changed = false;
+      bestScore = -1;
+      const auto candidates = Preselect(depth);
+      if (candidates.empty()) {
+        return Node::kSatisfied;
+      }
+      // Literals implied by the first literal of a candidate, in its lookahead.
+      std::vector<Lit> first;
+      for (const Var x : candidates) {
+        double h[2] = {0, 0};
+        bool forced = false;
+        for (int i = 0; i < 2 && !forced && IsFree(x); ++i) {
+          const Lit l = i == 0 ? Lit(x) : ~x;
+          if (!LookAhead(l)) {
+            ++stats.failed;
+            if (!Force(~l)) {
+              return Node::kConflict;
+            }
+            forced = true;
+            break;
+          }
+          if (weight == 0) {
+            ++stats.autarkies;
+            if (!Force(l)) {
+              return Node::kConflict;
+            }
+            forced = true;
+            break;
+          }
+          h[i] = weight;
+          std::vector<Lit> necessary;
+          if (i == 0) {
+            first = implied;
+          } else {
+            for (const Lit u : first) {
+              if (LA[u.ID()] == stamp) {
+                necessary.push_back(u);
+              }
+            }
+          }
+          for (const Lit v : windfalls) {
+            ++stats.windfalls;
+            AddBinary(~l, v);
+          }
+          int resolvents = 0;
+          for (size_t j = 0; j < BIMP[(~l).ID()].size() && !windfalls.empty() &&
+                             resolvents < kMaxResolvents;
+               ++j) {
+            const Lit w = BIMP[(~l).ID()][j];
+            if (!IsFree(w) || LA[w.ID()] == stamp) {
+              continue;
+            }
+            for (size_t k = 0; k < windfalls.size() && resolvents < kMaxResolvents;
+                 ++k) {
+              if (windfalls[k] != ~w) {
+                ++stats.resolvents;
+                ++resolvents;
+                AddBinary(w, windfalls[k]);
+              }
+            }
+          }
+          if (weight > trigger && !DoubleLookAhead(l, candidates)) {
+            ++stats.failed;
+            if (!Force(~l)) {
+              return Node::kConflict;
+            }
+            forced = true;
+            break;
+          }
+          for (const Lit u : necessary) {
+            ++stats.necessary;
+            if (!Force(u)) {
+              return Node::kConflict;
+            }
+            forced = true;
+          }
+        }
+        if (forced) {
+          changed = true;
+          continue;
+        }
+        if (!IsFree(x)) {
+          continue;
+        }
+        const double score = 1024 * h[0] * h[1] + h[0] + h[1];
+        if (score > bestScore) {
+          bestScore = score;
+          // h[0] <= h[1] if x reduces fewer clauses than ~x.
+          branch = h[0] <= h[1] ? Lit(x) : ~x;
+        }
+      }
+    }
+    return Node::kBranch;
+  }
+
+  std::pair<Result, Assignment> Run() {
+    const int n = s.NumVars();
+    BIMP.resize(2 * n + 2);
+    KINX.resize(2 * n + 2);
+    VAL.assign(n + 1, 0);
+    LA.assign(2 * n + 2, 0);
+    Clause clause;
+    Clause units;
+    for (const auto c : s.clauses_) {
+      clause.assign(c.begin(), c.end());
+      if (!Normalize(clause)) {
+        continue;
+      }
+      if (clause.empty()) {
+        return {Result::kUNSAT, {}};
+      }
+      if (clause.size() == 1) {
+        units.push_back(clause[0]);
+      } else if (clause.size() == 2) {
+        AddBinary(clause[0], clause[1]);
+      } else if (clause.size() > 2) {
+        for (const Lit l : clause) {
+          KINX[l.ID()].push_back(static_cast<int>(big.size()));
+        }
+        CSIZE.push_back(static_cast<int>(clause.size()));
+        big.push_back(clause);
+      }
+    }
+    ACTIVE.assign(big.size(), true);
+    LCSIZE.assign(big.size(), 0);
+    LCSTAMP.assign(big.size(), 0);
+    for (const Lit l : units) {
+      if (IsFalse(l)) {
+        return {Result::kUNSAT, {}};
+      }
+      if (IsFree(l)) {
+        Assign(l);
+      }
+    }
+    if (!Propagate()) {
+      return {Result::kUNSAT, {}};
+    }
+
+    // Decisions made so far, whether they've been flipped, and where to
+    // backtrack to in order to undo them.
+    struct Level {
+      Lit decision;
+      bool flipped;
+      Mark mark;
+    };
+    std::vector<Level> levels;
+    for (;;) {
+      if (s.Interrupted(stats.backtracks, stats.propagations)) {
+        LOG << stats.ToString();
+        return {Result::kUnknown, {}};
+      }
+      ++stats.nodes;
+      Lit branch = Lit(Var(1));
+      const Node node =
+          LookAheadNode(static_cast<int>(levels.size()) + 1, branch);
+      if (node == Node::kSatisfied) {
+        LOG << stats.ToString();
+        Assignment sol;
+        for (int x = 1; x <= n; ++x) {
+          sol.push_back(VAL[x] > 0 ? Lit(Var(x)) : ~Var(x));
+        }
+        return {Result::kSAT, sol};
+      }
+      if (node == Node::kBranch) {
+        levels.push_back({branch, false, GetMark()});
+        Assign(branch);
+        if (Propagate()) {
+          continue;
+        }
+      }
+      // Tries the other value of the last decision not flipped yet.
+      for (bool resumed = false; !resumed;) {
+        if (levels.empty()) {
+          LOG << stats.ToString();
+          return {Result::kUNSAT, {}};
+        }
+        ++stats.backtracks;
+        Level &level = levels.back();
+        Backtrack(level.mark);
+        if (level.flipped) {
+          levels.pop_back();
+          continue;
+        }
+        level.flipped = true;
+        Assign(~level.decision);
+        resumed = Propagate();
+      }
+    }
+  }
+};
+
+std::pair<Result, Assignment> L::Solve() {
+  StartSearch();
+  Search search(*this);
+  return search.Run();
+}
+
+std::pair<Result, std::vector<Assignment>> L::SolveAll() {
+  C c;
+  CopyTo(NumVars(), clauses_, c);
+  return c.SolveAll();
+}
+
+} // namespace algorithm
+} // namespace solver
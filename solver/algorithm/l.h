@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "solver/solver.h"
+
+namespace solver {
+namespace algorithm {
+
+/*
+ * 7.2.2.2 - Algorithm L (Satisfiability by lookahead) - p38
+ *
+ * A DPLL search that decides which variable to branch on by looking ahead on
+ * both values of the most promising ones. Binary clauses are kept as a 2SAT
+ * implication structure, and longer clauses become binary ones as they're
+ * reduced, as in the extension of the algorithm to k-SAT in exercise 143.
+ *
+ * Looking ahead on a literal propagates it through the binary implications,
+ * weighting the longer clauses it reduces by their new length, and derives:
+ *  - failed literals, whose propagation is contradictory, so that they're
+ *    set false;
+ *  - autarkies, literals reducing no clause, so that they're set true;
+ *  - necessary assignments, literals implied by both values of a variable;
+ *  - windfalls, binary clauses made of the negation of the literal and the
+ *    single literal left in a reduced clause;
+ *  - compensation resolvents, binary clauses resolved from a windfall and a
+ *    binary clause on the negation of the literal.
+ * Literals whose lookahead reduces the clauses enough are looked ahead twice,
+ * i.e. every candidate is looked ahead again with them set, learning a binary
+ * clause for each literal failing then.
+ */
+class L : public Solver {
+public:
+  L() {}
+
+  std::pair<Result, Assignment> Solve() override;
+  // Lists the models with Algorithm C.
+  std::pair<Result, std::vector<Assignment>> SolveAll() override;
+  std::string ID() const override { return "L"; }
+
+private:
+  struct Search;
+};
+
+} // namespace algorithm
+} // namespace solver
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <algorithm>
+
+namespace solver {
+namespace algorithm {
+
+// Weight given by lookaheads to a clause reduced to k > 1 literals, indexed by
+// min(k, kMaxWeighed): a clause reduced to two literals weighs as much as five
+// reduced to three, and so on.
+constexpr int kMaxWeighed = 8;
+constexpr double kWeights[kMaxWeighed + 1] = {
+    0, 0, 1, 0.2, 0.04, 0.008, 0.0016, 0.00032, 0.000064};
+
+inline double ReducedWeight(int k) {
+  return kWeights[std::min(k, kMaxWeighed)];
+}
+
+} // namespace algorithm
+} // namespace solver
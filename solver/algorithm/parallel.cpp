@@ -0,0 +1,198 @@
+#include "solver/algorithm/parallel.h"
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+#include "solver/algorithm/race.h"
+#include "util/log.h"
+#include "util/work_stealing_pool.h"
+
+namespace solver {
+namespace algorithm {
+
+namespace {
+
+// Log2 of the number of subproblems per thread, so that threads finishing
+// early still find work to steal from the others.
+constexpr int kSplitBitsPerThread = 4;
+
+} // namespace
+
+Parallel::Parallel(Factory factory, int numThreads)
+    : factory_(std::move(factory)), numThreads_(numThreads) {
+  id_ = factory_()->ID();
+}
+
+std::pair<Result, Assignment> Parallel::Solve() {
+  Assignment sol;
+  auto res = SolveInternal(
+      [&](uint64_t, const Assignment &model) {
+        sol = model;
+        return false;
+      },
+      false);
+  return {res, sol};
+}
+
+std::pair<Result, std::vector<Assignment>> Parallel::SolveAll() {
+  // found[path] = solutions of the subproblem for path.
+  std::map<uint64_t, std::vector<Assignment>> found;
+  auto res = SolveInternal(
+      [&](uint64_t path, const Assignment &model) {
+        found[path].push_back(model);
+        return true;
+      },
+      true);
+  std::vector<Assignment> sols;
+  for (auto &[path, models] : found) {
+    std::move(models.begin(), models.end(), std::back_inserter(sols));
+  }
+  return {res, sols};
+}
+
+Result Parallel::SolveAll(const ModelFn &fn) {
+  return SolveInternal(
+      [&](uint64_t, const Assignment &model) { return fn(model); }, true);
+}
+
+// The value of variable x <= d is bit d-x of path, so that paths of the same
+// length sort like their prefixes.
+bool Parallel::Restrict(uint64_t path, int d, Solver *out) const {
+  auto value = [&](int x) { return ((path >> (d - x)) & 1) != 0; };
+  if (out != nullptr) {
+    out->Reset();
+    out->Reserve(NumVars(), NumClauses() + d, clauses_.Words() + d);
+    for (int x = 1; x <= NumVars(); ++x) {
+      out->NewVar();
+    }
+    for (int x = 1; x <= d; ++x) {
+      out->AddClause({value(x) ? Lit(Var(x)) : ~Var(x)});
+    }
+  }
+  Clause clause;
+  for (const auto c : clauses_) {
+    clause.clear();
+    bool satisfied = false;
+    for (const Lit lit : c) {
+      if (lit.VID() > d) {
+        clause.push_back(lit);
+      } else if (value(lit.VID()) == lit.IsPos()) {
+        satisfied = true;
+        break;
+      }
+    }
+    if (satisfied) {
+      continue;
+    }
+    if (clause.empty()) {
+      return false;
+    }
+    if (out != nullptr) {
+      out->AddClause(clause);
+    }
+  }
+  return true;
+}
+
+Result Parallel::SolveInternal(const PathModelFn &fn, bool all) {
+  StartSearch();
+  const int numThreads = Race::NumThreads(numThreads_);
+  // Depth at which the tree is split into subproblems.
+  int depth = 0;
+  if (numThreads > 1) {
+    while ((1 << depth) < numThreads) {
+      ++depth;
+    }
+    depth = std::min(NumVars(), depth + kSplitBitsPerThread);
+  }
+  LOG << "splitting the search tree at depth " << depth << " for "
+      << numThreads << " threads";
+
+  std::vector<std::unique_ptr<Solver>> engines;
+  Race race([this](int64_t conflicts, int64_t propagations) {
+    return Interrupted(conflicts, propagations);
+  });
+  // Guarded by race.mu, like fn.
+  bool unknown = false;
+  bool found = false;
+
+  for (int i = 0; i < numThreads; ++i) {
+    engines.push_back(factory_());
+    race.Add(*engines.back());
+  }
+
+  util::WorkStealingPool pool(numThreads);
+  // Expands the node of the search tree for the values in path of the first d
+  // variables.
+  std::function<void(int, uint64_t, int)> Expand = [&](int w, uint64_t path,
+                                                       int d) {
+    if (race.Stopped()) {
+      return;
+    }
+    if (d < depth) {
+      if (Restrict(path, d, nullptr)) {
+        for (uint64_t v : {0, 1}) {
+          pool.Push(w, [&Expand, path, d, v](int w) {
+            Expand(w, (path << 1) | v, d + 1);
+          });
+        }
+      }
+      return;
+    }
+    Solver &e = *engines[w];
+    if (!Restrict(path, d, &e)) {
+      return;
+    }
+    Result res;
+    if (all) {
+      res = e.SolveAll([&](const Assignment &model) {
+        std::lock_guard<std::mutex> lock(race.mu);
+        if (race.Stopped()) {
+          return false;
+        }
+        found = true;
+        if (!fn(path, model)) {
+          race.Stop();
+        }
+        return !race.Stopped();
+      });
+    } else {
+      Assignment sol;
+      std::tie(res, sol) = e.Solve();
+      if (res == Result::kSAT) {
+        std::lock_guard<std::mutex> lock(race.mu);
+        if (!race.Stopped()) {
+          found = true;
+          fn(path, sol);
+          race.Stop();
+        }
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(race.mu);
+    race.Finish(w);
+    if (race.Stopped()) {
+      return;
+    }
+    if (res == Result::kUnknown) {
+      unknown = true;
+    }
+    race.Check();
+  };
+  pool.Push(0, [&Expand](int w) { Expand(w, 0, 0); });
+  pool.Run();
+
+  if (!all && found) {
+    return Result::kSAT;
+  }
+  if (race.Interrupted() || unknown) {
+    return Result::kUnknown;
+  }
+  return found ? Result::kSAT : Result::kUNSAT;
+}
+
+} // namespace algorithm
+} // namespace solver
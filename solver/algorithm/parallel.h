@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "solver/solver.h"
+
+namespace solver {
+namespace algorithm {
+
+/*
+ * Runs one of the backtracking algorithms A, B or D on several threads.
+ *
+ * The search tree is split on the values of the first variables into
+ * subproblems, each made of the clauses simplified by a fixed prefix of
+ * decisions, plus unit clauses for the prefix itself. The subproblems are
+ * expanded and solved by a work-stealing pool, each thread running its own
+ * instance of the algorithm. SolveAll merges the solutions of every subproblem
+ * in the order of their prefixes, while those streamed to a function come in
+ * the order they're found.
+ */
+class Parallel : public Solver {
+public:
+  using Factory = std::function<std::unique_ptr<Solver>()>;
+
+  // Runs the algorithms built by the factory on the given number of threads,
+  // or on as many as the hardware supports if 0.
+  explicit Parallel(Factory, int numThreads = 0);
+
+  std::pair<Result, Assignment> Solve() override;
+  std::pair<Result, std::vector<Assignment>> SolveAll() override;
+  Result SolveAll(const ModelFn &) override;
+  std::string ID() const override { return "P" + id_; }
+
+private:
+  // Like ModelFn, also given the path of the subproblem of the assignment.
+  using PathModelFn = std::function<bool(uint64_t, const Assignment &)>;
+
+  Factory factory_;
+  int numThreads_;
+  std::string id_;
+
+  Result SolveInternal(const PathModelFn &, bool);
+  // Adds the clauses simplified by the values of the first d variables in
+  // path, and unit clauses for those values, to the given solver, unless it's
+  // null. Returns false if the values falsify any clause.
+  bool Restrict(uint64_t path, int d, Solver *) const;
+};
+
+} // namespace algorithm
+} // namespace solver
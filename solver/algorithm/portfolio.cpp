@@ -0,0 +1,86 @@
+#include "solver/algorithm/portfolio.h"
+
+#include <memory>
+#include <mutex>
+
+#include "solver/algorithm/c.h"
+#include "solver/algorithm/race.h"
+#include "solver/clause_ring.h"
+#include "util/log.h"
+
+namespace solver {
+namespace algorithm {
+
+namespace {
+
+// Learned clauses are shared if they have at most this many literals, or an
+// LBD at most this.
+constexpr size_t kShareSize = 8;
+constexpr uint32_t kShareLBD = 2;
+
+// Number of clauses kept in the ring buffer.
+constexpr size_t kRingSize = 1 << 14;
+
+} // namespace
+
+std::pair<Result, Assignment> Portfolio::Solve() {
+  StartSearch();
+  const int numThreads = Race::NumThreads(numThreads_);
+
+  ClauseRing ring(kRingSize);
+  std::vector<ClauseRing::Cursor> cursors(numThreads, 0);
+  std::vector<std::unique_ptr<C>> engines;
+  Race race([this](int64_t conflicts, int64_t propagations) {
+    return Interrupted(conflicts, propagations);
+  });
+  // Guarded by race.mu.
+  Result res = Result::kUnknown;
+  Assignment sol;
+
+  // Instances differ in their seed, restart policy and initial phase, in such
+  // a way that the first one runs like C would.
+  constexpr C::Phase kPhases[] = {C::Phase::kNegative, C::Phase::kPositive,
+                                  C::Phase::kRandom};
+  for (int i = 0; i < numThreads; ++i) {
+    engines.push_back(std::make_unique<C>());
+    C &e = *engines.back();
+    e.SetSeed(static_cast<uint32_t>(i));
+    e.SetPhase(kPhases[i % 3]);
+    e.SetRestarts(i % 2 == 0 ? C::Restarts::kFlush : C::Restarts::kLuby);
+    if (numThreads > 1) {
+      e.SetClauseSharing(
+          [&ring, i](const Clause &c, uint32_t lbd) {
+            if (c.size() <= kShareSize || lbd <= kShareLBD) {
+              ring.Push(i, c, lbd);
+            }
+          },
+          [&ring, &cursors, i](std::vector<C::SharedClause> &out) {
+            ring.Pull(i, cursors[i], out);
+          });
+    }
+    race.Add(e);
+    CopyTo(NumVars(), clauses_, e);
+  }
+  LOG << "running a portfolio of " << numThreads << " instances";
+
+  Race::Run(numThreads, [&](int i) {
+    auto [r, s] = engines[i]->Solve();
+    std::lock_guard<std::mutex> lock(race.mu);
+    if (!race.Stopped() && r != Result::kUnknown) {
+      LOG << "instance " << i << " finished first";
+      res = r;
+      sol = std::move(s);
+      race.Stop();
+    }
+  });
+  return {res, sol};
+}
+
+std::pair<Result, std::vector<Assignment>> Portfolio::SolveAll() {
+  C c;
+  CopyTo(NumVars(), clauses_, c);
+  return c.SolveAll();
+}
+
+} // namespace algorithm
+} // namespace solver
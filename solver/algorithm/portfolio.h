@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "solver/solver.h"
+
+namespace solver {
+namespace algorithm {
+
+/*
+ * Runs several instances of Algorithm C on the same clauses, each on its own
+ * thread with its own seed, restart policy and initial phase, and returns the
+ * answer of the first one to finish, stopping the others.
+ *
+ * Short or low-LBD learned clauses are published to the others through a
+ * lock-free ring buffer, and each instance imports those published since its
+ * last poll every so many conflicts.
+ */
+class Portfolio : public Solver {
+public:
+  // Runs the given number of instances, or as many as the hardware supports if
+  // 0.
+  explicit Portfolio(int numThreads = 0) : numThreads_(numThreads) {}
+
+  std::pair<Result, Assignment> Solve() override;
+  // Lists the models with a single instance.
+  std::pair<Result, std::vector<Assignment>> SolveAll() override;
+  std::string ID() const override { return "PC"; }
+
+private:
+  int numThreads_;
+};
+
+} // namespace algorithm
+} // namespace solver
@@ -0,0 +1,63 @@
+#include "solver/algorithm/race.h"
+
+#include <algorithm>
+#include <numeric>
+#include <thread>
+
+namespace solver {
+namespace algorithm {
+
+int Race::NumThreads(int numThreads) {
+  return numThreads > 0 ? numThreads
+                        : std::max(1, static_cast<int>(
+                                          std::thread::hardware_concurrency()));
+}
+
+void Race::Run(int numThreads, const std::function<void(int)> &fn) {
+  std::vector<std::thread> threads;
+  for (int i = 1; i < numThreads; ++i) {
+    threads.emplace_back(fn, i);
+  }
+  fn(0);
+  for (auto &t : threads) {
+    t.join();
+  }
+}
+
+void Race::Add(Solver &engine) {
+  const int i = static_cast<int>(engines_.size());
+  engines_.push_back(&engine);
+  running_.push_back(0);
+  engine.SetTerminate([this, i]() {
+    std::lock_guard<std::mutex> lock(mu);
+    running_[i] = engines_[i]->GetUsage().conflicts;
+    return Check();
+  });
+}
+
+void Race::Finish(int i) {
+  conflicts_ += engines_[i]->GetUsage().conflicts;
+  running_[i] = 0;
+}
+
+bool Race::Check(int64_t propagations) {
+  propagations_ += propagations;
+  if (!stop_ &&
+      interruptedFn_(
+          std::accumulate(running_.begin(), running_.end(), conflicts_),
+          propagations_)) {
+    interrupted_ = true;
+    Stop();
+  }
+  return stop_;
+}
+
+void Race::Stop() {
+  stop_ = true;
+  for (Solver *e : engines_) {
+    e->Terminate();
+  }
+}
+
+} // namespace algorithm
+} // namespace solver
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "solver/solver.h"
+
+namespace solver {
+namespace algorithm {
+
+/*
+ * Shared state of the threads of a parallel algorithm, each running its own
+ * engine under the budget of the algorithm, until one of them answers or the
+ * budget runs out and every engine is stopped.
+ *
+ * The budget is checked against the conflicts of every engine together, plus
+ * the propagations counted by the algorithm itself, with mu held. The
+ * algorithm keeps its answer under mu as well, and stops the others once it
+ * has one.
+ */
+class Race {
+public:
+  // Checks the budget of the algorithm given the number of conflicts and
+  // propagations so far.
+  using InterruptFn = std::function<bool(int64_t, int64_t)>;
+
+  explicit Race(InterruptFn interrupted)
+      : interruptedFn_(std::move(interrupted)), conflicts_(0),
+        propagations_(0), stop_(false), interrupted_(false) {}
+
+  Race(const Race &) = delete;
+  Race &operator=(const Race &) = delete;
+
+  // Returns the given number of threads, or as many as the hardware supports
+  // if 0.
+  static int NumThreads(int numThreads);
+
+  // Runs fn(i) for every i < numThreads, each on its own thread, including the
+  // calling one for i = 0, and returns once they're all done.
+  static void Run(int numThreads, const std::function<void(int)> &fn);
+
+  // Adds the engine, so that Stop terminates it and it checks the budget
+  // whenever it checks its own. It's known as the number of engines added
+  // before it. Engines are all added before any of them runs.
+  void Add(Solver &engine);
+
+  // Counts the conflicts of the last search of engine i for good, before it
+  // moves on to another. Called with mu held.
+  void Finish(int i);
+
+  // Adds to the propagations counted towards the budget, and stops every
+  // engine if the budget ran out. Returns whether they're stopped. Called with
+  // mu held.
+  bool Check(int64_t propagations = 0);
+
+  // Stops every engine. Called with mu held.
+  void Stop();
+
+  bool Stopped() const { return stop_; }
+  // Whether the engines were stopped because the budget ran out.
+  bool Interrupted() const { return interrupted_; }
+
+  // Guards the budget, the answer of the algorithm and everything below.
+  std::mutex mu;
+
+private:
+  InterruptFn interruptedFn_;
+  std::vector<Solver *> engines_;
+  // Conflicts of the searches finished, and of those running on each engine.
+  int64_t conflicts_;
+  std::vector<int64_t> running_;
+  int64_t propagations_;
+  std::atomic<bool> stop_;
+  bool interrupted_;
+};
+
+} // namespace algorithm
+} // namespace solver
@@ -0,0 +1,72 @@
+#include "solver/algorithm/w.h"
+
+#include <mutex>
+#include <random>
+
+#include "solver/algorithm/race.h"
+#include "util/log.h"
+
+namespace solver {
+namespace algorithm {
+
+namespace {
+
+// Number of flips of each walk between checks of the budget.
+constexpr int64_t kCheckFlips = 1 << 12;
+
+} // namespace
+
+std::pair<Result, Assignment> W::Solve() {
+  StartSearch();
+  LocalSearch::Instance in(NumVars());
+  for (const auto c : clauses_) {
+    in.Add(Clause(c.begin(), c.end()));
+  }
+  in.Index();
+  if (in.empty) {
+    return {Result::kUNSAT, {}};
+  }
+  const int numThreads = Race::NumThreads(numThreads_);
+  const uint32_t seed = seeded_ ? seed_ : std::random_device()();
+
+  // Walks have no engine to stop, so they poll race.Stopped() instead.
+  Race race([this](int64_t conflicts, int64_t propagations) {
+    return Interrupted(conflicts, propagations);
+  });
+  // Guarded by race.mu.
+  bool found = false;
+  Assignment sol;
+
+  Race::Run(numThreads, [&](int i) {
+    LocalSearch walk(in, mode_, noise_, seed + i);
+    for (int64_t n = 0;; n += kCheckFlips) {
+      if (walk.Run(kCheckFlips)) {
+        std::lock_guard<std::mutex> lock(race.mu);
+        if (!race.Stopped()) {
+          LOG << "walk " << i << " satisfied every clause after less than "
+              << n + kCheckFlips << " flips";
+          found = true;
+          sol = walk.Model();
+          race.Stop();
+        }
+        return;
+      }
+      std::lock_guard<std::mutex> lock(race.mu);
+      if (race.Check(kCheckFlips)) {
+        return;
+      }
+    }
+  });
+
+  if (!found) {
+    return {Result::kUnknown, {}};
+  }
+  return {Result::kSAT, sol};
+}
+
+std::pair<Result, std::vector<Assignment>> W::SolveAll() {
+  return {Result::kUnknown, {}};
+}
+
+} // namespace algorithm
+} // namespace solver
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "solver/local_search.h"
+#include "solver/solver.h"
+
+namespace solver {
+namespace algorithm {
+
+/*
+ * 7.2.2.2 - Algorithm W (WalkSAT)
+ *
+ * Stochastic local search: starting from a random assignment, repeatedly picks
+ * an unsatisfied clause at random and flips one of its variables, until every
+ * clause is satisfied. See LocalSearch for the WalkSAT and probSAT walks.
+ *
+ * Several walks with independent seeds run on as many threads, and the first
+ * one to satisfy every clause wins. The search is incomplete: it only returns
+ * kUNSAT for instances with an empty clause, and otherwise runs until it finds
+ * a solution or it's interrupted. Each flip counts as a propagation towards the
+ * budget.
+ *
+ * @see: B. Selman, H. Kautz and B. Cohen, Noise strategies for improving local
+ *       search, AAAI 1994.
+ * @see: A. Balint and U. Schöning, Choosing probability distributions for
+ *       stochastic local search and the role of make versus break, SAT 2012.
+ */
+class W : public Solver {
+public:
+  using Mode = LocalSearch::Mode;
+
+  // Runs the given number of walks, or as many as the hardware supports if 0.
+  explicit W(Mode mode = Mode::kWalkSAT, int numThreads = 0)
+      : mode_(mode), numThreads_(numThreads), seeded_(false), seed_(0),
+        noise_(0.567) {}
+
+  std::pair<Result, Assignment> Solve() override;
+  // Not supported by local search, so it returns kUnknown.
+  std::pair<Result, std::vector<Assignment>> SolveAll() override;
+  std::string ID() const override {
+    return mode_ == Mode::kProbSAT ? "WP" : "W";
+  }
+
+  // Seeds the walks, which are seeded from the system otherwise.
+  void SetSeed(uint32_t seed) {
+    seeded_ = true;
+    seed_ = seed;
+  }
+
+  // Sets the probability p of WalkSAT flipping a random variable of the
+  // clause rather than a greedy one.
+  void SetNoise(double p) { noise_ = p; }
+
+private:
+  Mode mode_;
+  int numThreads_;
+  bool seeded_;
+  uint32_t seed_;
+  double noise_;
+};
+
+} // namespace algorithm
+} // namespace solver
@@ -1,64 +1,280 @@
 #include "solver/algorithm/z.h"
 
 #include <algorithm>
-#include <functional>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <thread>
 
 namespace solver {
 namespace algorithm {
 
+namespace {
+
+// Number of variables whose values are enumerated within a single word.
+constexpr int kWordVars = 6;
+
+// Values of variables 1 to 6 in the 64 assignments of a word, where bit b
+// assigns the value of bit i-1 of b to variable i.
+constexpr uint64_t kWordValues[kWordVars] = {
+    0xAAAAAAAAAAAAAAAA, 0xCCCCCCCCCCCCCCCC, 0xF0F0F0F0F0F0F0F0,
+    0xFF00FF00FF00FF00, 0xFFFF0000FFFF0000, 0xFFFFFFFF00000000,
+};
+
+// Log2 of the number of words in a chunk, the unit of work of each thread.
+constexpr int kChunkBits = 10;
+
+// Number of chunks per thread that can be claimed beyond the first one whose
+// solutions weren't all handed to fn yet, which bounds those kept waiting.
+constexpr uint64_t kChunksAhead = 4;
+
+// The remaining variables can't possibly be enumerated beyond this.
+constexpr int kMaxWordBits = 62;
+
+} // namespace
+
 std::pair<Result, Assignment> Z::Solve() {
-  std::vector<Lit> cur;
-  cur.reserve(NumVars());
+  Assignment sol;
+  auto res = SolveInternal(
+      [&](const Assignment &model) {
+        sol = model;
+        return false;
+      },
+      false);
+  return {res, sol};
+}
 
-  std::function<bool(int)> Search = [&](int i) {
-    if (i == 0) {
-      return Verify(cur);
-    }
-    Var x(i);
-    for (auto lit : {Lit(x), Lit(~x)}) {
-      cur.push_back(lit);
-      if (Search(i - 1)) {
+std::pair<Result, std::vector<Assignment>> Z::SolveAll() {
+  std::vector<Assignment> sols;
+  auto res = SolveInternal(
+      [&](const Assignment &model) {
+        sols.push_back(model);
         return true;
+      },
+      true);
+  if (res == Result::kUNSAT) {
+    return {res, {}};
+  }
+  return {res, sols};
+}
+
+Result Z::SolveAll(const ModelFn &fn) { return SolveInternal(fn, true); }
+
+// Assignments are enumerated 64 at a time: the first k variables take every
+// combination of values across the bits of a word, and the remaining h
+// variables take a single value per word, following a Gray code so that
+// moving to the next word flips a single variable.
+//
+// word[l] = values of literal l in each of the assignments of the word.
+//
+// Clauses are evaluated by OR-ing the words of their literals, and the bits
+// left set after AND-ing every clause are satisfying assignments. The part of
+// each clause over the first k variables is constant, so it's computed once,
+// and clauses over those only are folded into a single base mask.
+Result Z::SolveInternal(const ModelFn &fn, bool all) {
+  StartSearch();
+  const int n = NumVars();
+  const int k = std::min(n, kWordVars);
+  const int h = n - k;
+  if (h > kMaxWordBits) {
+    COMMENT << "too many variables to try every assignment: n=" << n;
+    return Result::kUnknown;
+  }
+
+  // Compile the clauses, with those with fewer varying literals first, since
+  // they're more likely to rule out every assignment of a word early.
+  uint64_t base =
+      k == kWordVars ? ~uint64_t(0) : (uint64_t(1) << (1 << k)) - 1;
+  std::vector<std::pair<uint64_t, std::vector<int>>> compiled;
+  for (const auto c : clauses_) {
+    uint64_t low = 0;
+    std::vector<int> high;
+    for (const Lit lit : c) {
+      const int x = lit.VID();
+      if (x <= k) {
+        low |= lit.IsPos() ? kWordValues[x - 1] : ~kWordValues[x - 1];
+      } else {
+        high.push_back(lit.ID());
       }
-      cur.pop_back();
     }
-    return false;
-  };
-
-  if (Search(n_)) {
-    return {Result::kSAT, cur};
+    if (high.empty()) {
+      base &= low;
+    } else {
+      compiled.emplace_back(low, std::move(high));
+    }
   }
-  return {Result::kUNSAT, {}};
-}
+  std::stable_sort(compiled.begin(), compiled.end(),
+                   [](const auto &a, const auto &b) {
+                     return a.second.size() < b.second.size();
+                   });
+  // LOW[i]   = constant part of clause i.
+  // START[i] = first cell of clause i, with its literals in the cells
+  //            START[i] to START[i+1]-1.
+  // L[p]     = literal in cell p.
+  std::vector<uint64_t> LOW;
+  std::vector<int> START{0};
+  std::vector<int> L;
+  for (const auto &[low, high] : compiled) {
+    LOW.push_back(low);
+    L.insert(L.end(), high.begin(), high.end());
+    START.push_back(L.size());
+  }
+  const size_t m = LOW.size();
 
-std::pair<Result, std::vector<Assignment>> Z::SolveAll() {
-  std::vector<Assignment> all;
-  std::vector<Lit> cur;
-  cur.reserve(NumVars());
-
-  std::function<void(int)> Search = [&](int i) {
-    if (i == 0) {
-      if (Verify(cur)) {
-        all.push_back(cur);
-        LOG << "solution = [" << ToString(cur) << "]";
+  // Words are split in chunks handed out to threads in order. The solutions
+  // of each chunk are handed to fn in the same order: the thread on the first
+  // chunk not handed over yet hands its solutions as it finds them, while the
+  // others keep theirs until every chunk before theirs was handed over.
+  const int chunkBits = std::min(h, kChunkBits);
+  const uint64_t numChunks = uint64_t(1) << (h - chunkBits);
+  const uint64_t numThreads = std::min<uint64_t>(
+      std::max(1u, std::thread::hardware_concurrency()), numChunks);
+  std::atomic<bool> stop(false);
+  // Guards Interrupted, fn and everything below. Threads wait on ahead while
+  // they're too far ahead of nextDone, until it moves or they're stopped.
+  std::mutex mu;
+  std::condition_variable ahead;
+  uint64_t nextChunk = 0;
+  int64_t tries = 0;
+  bool interrupted = false;
+  bool found = false;
+  bool halted = false; // whether fn asked to stop.
+  // done[c] = solutions of chunk c, done but not handed to fn yet.
+  std::map<uint64_t, std::vector<Assignment>> done;
+  // Changed with mu held, but read without it by the thread on chunk nextDone,
+  // which is the only one that can move it.
+  std::atomic<uint64_t> nextDone(0);
+
+  // Hands the solutions to fn until it asks to stop. Called with mu held.
+  auto Hand = [&](const std::vector<Assignment> &sols) {
+    for (const auto &sol : sols) {
+      if (halted) {
+        return;
+      }
+      found = true;
+      if (!fn(sol)) {
+        halted = stop = true;
+        ahead.notify_all();
       }
-      return;
     }
-    Var x(i);
-    for (auto lit : {Lit(x), Lit(~x)}) {
-      cur.push_back(lit);
-      Search(i - 1);
-      cur.pop_back();
+  };
+
+  // Hands the solutions of the chunks done so far to fn, in order, stopping at
+  // the first chunk not done unless every thread is done. Called with mu held.
+  auto Flush = [&](bool last) {
+    for (auto it = done.begin();
+         it != done.end() && (last || it->first == nextDone) && !halted;
+         it = done.erase(it), ++nextDone) {
+      Hand(it->second);
     }
+    ahead.notify_all();
   };
 
-  Search(n_);
+  // Appends the assignment in bit b of the word for Gray code g.
+  auto Append = [&](std::vector<Assignment> &sols, uint64_t g, int b) {
+    Assignment sol;
+    sol.reserve(n);
+    for (int x = 1; x <= n; ++x) {
+      const bool v = x <= k ? (b >> (x - 1)) & 1 : (g >> (x - k - 1)) & 1;
+      sol.push_back(v ? Lit(Var(x)) : ~Var(x));
+    }
+    sols.push_back(std::move(sol));
+  };
 
-  if (all.empty()) {
-    return {Result::kUNSAT, {}};
+  auto Work = [&]() {
+    std::vector<uint64_t> word(2 * n + 2, 0);
+    std::vector<Assignment> sols;
+    while (!stop.load(std::memory_order_relaxed)) {
+      uint64_t c;
+      {
+        std::unique_lock<std::mutex> lock(mu);
+        ahead.wait(lock, [&]() {
+          return !all || stop ||
+                 nextChunk < nextDone + kChunksAhead * numThreads;
+        });
+        if (stop || nextChunk >= numChunks) {
+          return;
+        }
+        c = nextChunk++;
+        // Every chunk tried counts as a conflict.
+        if (Interrupted(++tries)) {
+          interrupted = true;
+          stop = true;
+          ahead.notify_all();
+          return;
+        }
+      }
+      uint64_t i = c << chunkBits;
+      const uint64_t last = i + (uint64_t(1) << chunkBits);
+      uint64_t g = i ^ (i >> 1);
+      for (int x = k + 1; x <= n; ++x) {
+        word[2 * x] = (g >> (x - k - 1)) & 1 ? ~uint64_t(0) : 0;
+        word[2 * x + 1] = ~word[2 * x];
+      }
+      for (;;) {
+        uint64_t acc = base;
+        for (size_t j = 0; j < m && acc != 0; ++j) {
+          uint64_t w = LOW[j];
+          for (int p = START[j]; p < START[j + 1]; ++p) {
+            w |= word[L[p]];
+          }
+          acc &= w;
+        }
+        for (; acc != 0; acc &= acc - 1) {
+          Append(sols, g, __builtin_ctzll(acc));
+          if (!all) {
+            std::lock_guard<std::mutex> lock(mu);
+            if (!stop) {
+              found = true;
+              fn(sols.back());
+              stop = true;
+            }
+            return;
+          }
+          if (c == nextDone) {
+            std::lock_guard<std::mutex> lock(mu);
+            Hand(sols);
+            sols.clear();
+          }
+        }
+        if (++i == last || stop.load(std::memory_order_relaxed)) {
+          break;
+        }
+        // Gray codes of consecutive words differ in the lowest set bit of i.
+        const int x = k + 1 + __builtin_ctzll(i);
+        g ^= uint64_t(1) << (x - k - 1);
+        word[2 * x] = ~word[2 * x];
+        word[2 * x + 1] = ~word[2 * x + 1];
+      }
+      if (all) {
+        std::lock_guard<std::mutex> lock(mu);
+        done[c] = std::move(sols);
+        sols.clear();
+        Flush(false);
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (uint64_t t = 1; t < numThreads; ++t) {
+    threads.emplace_back(Work);
+  }
+  Work();
+  for (auto &t : threads) {
+    t.join();
   }
 
-  return {Result::kSAT, all};
+  // Only chunks after one that was interrupted can be left.
+  Flush(true);
+  if (!all && found) {
+    return Result::kSAT;
+  }
+  if (interrupted) {
+    return Result::kUnknown;
+  }
+  return found ? Result::kSAT : Result::kUNSAT;
 }
 
 } // namespace algorithm
@@ -8,14 +8,22 @@
 namespace solver {
 namespace algorithm {
 
-/* The slowest solver in the west. */
+/*
+ * The slowest solver in the west. Literally tries every assignment, although
+ * 64 at a time by evaluating the clauses over bit-sliced words of assignments,
+ * and splitting them across as many threads as the hardware supports.
+ */
 class Z : public Solver {
 public:
   Z() {}
 
   std::pair<Result, Assignment> Solve() override;
   std::pair<Result, std::vector<Assignment>> SolveAll() override;
+  Result SolveAll(const ModelFn &) override;
   std::string ID() const override { return "Z"; }
+
+private:
+  Result SolveInternal(const ModelFn &, bool);
 };
 
 } // namespace algorithm
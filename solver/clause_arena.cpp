@@ -0,0 +1,90 @@
+#include "solver/clause_arena.h"
+
+#include <algorithm>
+
+#include "solver/solver.h"
+#include "util/log.h"
+
+namespace solver {
+
+static_assert(sizeof(Lit) == sizeof(uint32_t),
+              "literals must fit in a single arena word");
+static_assert(std::is_trivially_copyable<Lit>::value,
+              "literals must be trivially copyable to live in the arena");
+static_assert(sizeof(ClauseHeader) % sizeof(uint32_t) == 0,
+              "clause header must span a whole number of arena words");
+
+CRef ClauseArena::Alloc(const Lit *lits, size_t size, bool learned) {
+  const size_t cr = mem_.size();
+  CHECK(cr + kHeaderWords + size < kNullRef)
+      << "clause arena is full: words=" << cr << " size=" << size;
+  mem_.resize(cr + kHeaderWords + size);
+  ClauseHeader &h = *reinterpret_cast<ClauseHeader *>(&mem_[cr]);
+  h.size = static_cast<uint32_t>(size);
+  h.learned = learned;
+  h.deleted = false;
+  h.used = false;
+  h.tier = 0;
+  h.transient = false;
+  h.lbd = 0;
+  h.activity = 0;
+  std::copy(lits, lits + size,
+            reinterpret_cast<Lit *>(mem_.data() + cr + kHeaderWords));
+  refs_.push_back(static_cast<CRef>(cr));
+  return static_cast<CRef>(cr);
+}
+
+void ClauseArena::Free(CRef cr) {
+  ClauseHeader &h = (*this)[cr].Header();
+  CHECK(!h.deleted) << "clause freed twice: cr=" << cr;
+  const size_t words = kHeaderWords + h.size;
+  if (!refs_.empty() && refs_.back() == cr) {
+    mem_.resize(cr);
+    refs_.pop_back();
+    ++generation_;
+    return;
+  }
+  if (!h.learned) {
+    ++generation_;
+  }
+  h.deleted = true;
+  wasted_ += words;
+  ++freed_;
+}
+
+void ClauseArena::Compact(const std::function<void(CRef, CRef)> &onMove) {
+  size_t to = 0;
+  size_t k = 0;
+  for (const CRef from : refs_) {
+    const ClauseHeader &h = (*this)[from].Header();
+    const size_t words = kHeaderWords + h.size;
+    if (h.deleted) {
+      continue;
+    }
+    if (from != to) {
+      // Moving towards the beginning never overwrites unvisited clauses.
+      std::copy(mem_.begin() + from, mem_.begin() + from + words,
+                mem_.begin() + to);
+      if (onMove) {
+        onMove(from, static_cast<CRef>(to));
+      }
+    }
+    refs_[k++] = static_cast<CRef>(to);
+    to += words;
+  }
+  refs_.resize(k);
+  mem_.resize(to);
+  wasted_ = 0;
+  freed_ = 0;
+  ++generation_;
+}
+
+void ClauseArena::Clear() {
+  mem_.clear();
+  refs_.clear();
+  wasted_ = 0;
+  freed_ = 0;
+  ++generation_;
+}
+
+} // namespace solver
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace solver {
+
+class Lit;
+
+// Reference to a clause stored in a ClauseArena.
+using CRef = uint32_t;
+
+// Clause header, stored inline right before the literals of the clause.
+struct ClauseHeader {
+  uint32_t size;
+  uint32_t learned : 1;
+  uint32_t deleted : 1;
+  // Whether a learned clause took part in a conflict recently.
+  uint32_t used : 1;
+  // Tier of a learned clause, as managed by the solver.
+  uint32_t tier : 2;
+  // Whether the clause only holds until the current call of the solver
+  // returns, which then frees it.
+  uint32_t transient : 1;
+  // Literal block distance of a learned clause, i.e. the number of distinct
+  // decision levels among its literals, or 0 if not computed.
+  uint32_t lbd : 26;
+  // Activity score of a learned clause.
+  float activity;
+};
+
+// A lightweight view over a clause stored in a ClauseArena. Views are
+// invalidated by any operation that may reallocate or move the arena memory,
+// i.e. ClauseArena::Alloc and ClauseArena::Compact.
+template <typename T> class BasicClauseView {
+  using H = std::conditional_t<std::is_const<T>::value, const ClauseHeader,
+                               ClauseHeader>;
+
+public:
+  explicit BasicClauseView(H *h) : h_(h) {}
+
+  // Allows converting a mutable view into a read-only view.
+  template <typename U, typename = std::enable_if_t<
+                            std::is_same<const U, T>::value &&
+                            !std::is_same<U, T>::value>>
+  BasicClauseView(const BasicClauseView<U> &that) : h_(&that.Header()) {}
+
+  size_t size() const { return h_->size; }
+  bool empty() const { return h_->size == 0; }
+  T &operator[](size_t i) const { return begin()[i]; }
+  T *begin() const { return reinterpret_cast<T *>(h_ + 1); }
+  T *end() const { return begin() + h_->size; }
+  std::reverse_iterator<T *> rbegin() const {
+    return std::reverse_iterator<T *>(end());
+  }
+  std::reverse_iterator<T *> rend() const {
+    return std::reverse_iterator<T *>(begin());
+  }
+
+  H &Header() const { return *h_; }
+  bool Learned() const { return h_->learned; }
+
+private:
+  H *h_;
+};
+
+using ClauseView = BasicClauseView<Lit>;
+using ConstClauseView = BasicClauseView<const Lit>;
+
+/*
+ * Contiguous storage for clauses.
+ *
+ * Each clause is laid out as a ClauseHeader immediately followed by its
+ * literals, so a whole instance lives in a single buffer and clauses are
+ * addressed by 32-bit references rather than by pointers. Freed clauses are
+ * skipped by iteration and their memory is reclaimed in place by Compact.
+ */
+class ClauseArena {
+  static constexpr size_t kHeaderWords =
+      sizeof(ClauseHeader) / sizeof(uint32_t);
+
+public:
+  static constexpr CRef kNullRef = std::numeric_limits<CRef>::max();
+
+  // Iterator over the live clauses, in allocation order.
+  template <typename A, typename V> class BasicIterator {
+  public:
+    BasicIterator(A &arena, size_t i) : arena_(arena), i_(i) { Skip(); }
+
+    V operator*() const { return arena_[arena_.refs_[i_]]; }
+    CRef Ref() const { return arena_.refs_[i_]; }
+    bool operator!=(const BasicIterator &that) const { return i_ != that.i_; }
+    BasicIterator &operator++() {
+      ++i_;
+      Skip();
+      return *this;
+    }
+
+  private:
+    A &arena_;
+    size_t i_;
+
+    void Skip() {
+      while (i_ < arena_.refs_.size() && arena_.IsFreed(arena_.refs_[i_])) {
+        ++i_;
+      }
+    }
+  };
+
+  using Iterator = BasicIterator<ClauseArena, ClauseView>;
+  using ConstIterator = BasicIterator<const ClauseArena, ConstClauseView>;
+
+  ClauseArena() : wasted_(0), freed_(0), generation_(0) {}
+
+  // Stores a new clause and returns its reference.
+  CRef Alloc(const Lit *lits, size_t size, bool learned = false);
+
+  // Marks the clause as freed. Its memory is reclaimed immediately if it's the
+  // most recently allocated clause, or on the next Compact otherwise.
+  void Free(CRef);
+
+  // Moves every live clause towards the beginning of the buffer, reclaiming
+  // the memory of freed clauses. The relative order of clauses is preserved,
+  // and onMove is called with the old and new references of every clause that
+  // changed location, after the move took place.
+  void Compact(const std::function<void(CRef, CRef)> &onMove = nullptr);
+
+  // Removes every clause.
+  void Clear();
+
+  // Reserves memory for the given number of clauses and literals.
+  void Reserve(size_t clauses, size_t lits) {
+    mem_.reserve(clauses * kHeaderWords + lits);
+    refs_.reserve(clauses);
+  }
+
+  ClauseView operator[](CRef cr) {
+    return ClauseView(reinterpret_cast<ClauseHeader *>(&mem_[cr]));
+  }
+  ConstClauseView operator[](CRef cr) const {
+    return ConstClauseView(reinterpret_cast<const ClauseHeader *>(&mem_[cr]));
+  }
+
+  bool IsFreed(CRef cr) const { return (*this)[cr].Header().deleted; }
+
+  // References of every clause in allocation order, including the freed
+  // clauses not yet reclaimed by Compact.
+  const std::vector<CRef> &Refs() const { return refs_; }
+
+  // Number of live clauses.
+  int NumClauses() const { return static_cast<int>(refs_.size() - freed_); }
+
+  // Number of 32-bit words in use, including those held by freed clauses.
+  size_t Words() const { return mem_.size(); }
+
+  // Number of 32-bit words held by freed clauses.
+  size_t WastedWords() const { return wasted_; }
+
+  // Counter increased whenever existing references may have been invalidated
+  // or reused, i.e. when clauses are moved or cleared, or when an original
+  // clause or the most recent clause is freed. Freeing any other learned clause
+  // leaves it unchanged, as does allocating new clauses.
+  uint64_t Generation() const { return generation_; }
+
+  Iterator begin() { return Iterator(*this, 0); }
+  Iterator end() { return Iterator(*this, refs_.size()); }
+  ConstIterator begin() const { return ConstIterator(*this, 0); }
+  ConstIterator end() const { return ConstIterator(*this, refs_.size()); }
+
+private:
+  std::vector<uint32_t> mem_;
+  std::vector<CRef> refs_;
+  size_t wasted_;
+  size_t freed_;
+  uint64_t generation_;
+};
+
+} // namespace solver
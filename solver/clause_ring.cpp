@@ -0,0 +1,86 @@
+#include "solver/clause_ring.h"
+
+namespace solver {
+
+ClauseRing::ClauseRing(size_t capacity) : head_(0) {
+  size_t n = 1;
+  while (n < capacity) {
+    n *= 2;
+  }
+  mask_ = n - 1;
+  slots_ = std::make_unique<Slot[]>(n);
+}
+
+bool ClauseRing::Push(int source, const Clause &clause, uint32_t lbd) {
+  if (clause.size() > kMaxSize) {
+    return false;
+  }
+  const uint64_t i = head_.fetch_add(1, std::memory_order_relaxed);
+  Slot &slot = slots_[i & mask_];
+  // Claim the slot, unless a writer of an earlier lap is still at it.
+  uint64_t seq = slot.seq.load(std::memory_order_relaxed);
+  do {
+    if ((seq & 1) != 0 || seq >= 2 * i + 2) {
+      uint64_t dropped = slot.dropped.load(std::memory_order_relaxed);
+      while (dropped < i + 1 &&
+             !slot.dropped.compare_exchange_weak(dropped, i + 1,
+                                                 std::memory_order_release,
+                                                 std::memory_order_relaxed)) {
+      }
+      return false;
+    }
+  } while (!slot.seq.compare_exchange_weak(seq, 2 * i + 1,
+                                           std::memory_order_relaxed));
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot.source.store(source, std::memory_order_relaxed);
+  slot.lbd.store(lbd, std::memory_order_relaxed);
+  slot.size.store(static_cast<uint32_t>(clause.size()),
+                  std::memory_order_relaxed);
+  for (size_t j = 0; j < clause.size(); ++j) {
+    slot.lits[j].store(clause[j].ID(), std::memory_order_relaxed);
+  }
+  slot.seq.store(2 * i + 2, std::memory_order_release);
+  return true;
+}
+
+void ClauseRing::Pull(int source, Cursor &cursor,
+                      std::vector<std::pair<Clause, uint32_t>> &out) const {
+  const uint64_t head = head_.load(std::memory_order_acquire);
+  // Clauses more than a lap behind are gone.
+  if (head - cursor > mask_ + 1) {
+    cursor = head - (mask_ + 1);
+  }
+  std::vector<int> lits;
+  for (; cursor < head; ++cursor) {
+    const Slot &slot = slots_[cursor & mask_];
+    const uint64_t seq = slot.seq.load(std::memory_order_acquire);
+    if (seq < 2 * cursor + 2) {
+      if (slot.dropped.load(std::memory_order_acquire) > cursor) {
+        // Dropped, or given up by a later lap.
+        continue;
+      }
+      // Still being written, so try again next time.
+      break;
+    }
+    if (seq > 2 * cursor + 2) {
+      // Already overwritten.
+      continue;
+    }
+    const int from = slot.source.load(std::memory_order_relaxed);
+    const uint32_t lbd = slot.lbd.load(std::memory_order_relaxed);
+    const uint32_t size = slot.size.load(std::memory_order_relaxed);
+    lits.clear();
+    for (uint32_t j = 0; j < size && j < kMaxSize; ++j) {
+      lits.push_back(slot.lits[j].load(std::memory_order_relaxed));
+    }
+    // Discard the clause if it was overwritten while being read.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) != seq || from == source) {
+      continue;
+    }
+    out.emplace_back(Clause(lits.begin(), lits.end()), lbd);
+  }
+}
+
+} // namespace solver
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "solver/solver.h"
+
+namespace solver {
+
+/*
+ * Lock-free ring buffer broadcasting short clauses between threads, e.g.
+ * learned clauses shared by solvers working on the same instance.
+ *
+ * Any thread can publish a clause, which is then read by every other thread
+ * through its own cursor. Publishing never waits: a clause is dropped if it's
+ * too long or if its slot is still being written by a thread lapped by the
+ * others, which is marked on the slot. Readers don't wait either, and skip the
+ * clauses dropped or overwritten before they got to them, so slow readers just
+ * miss some. Each slot is guarded by a sequence number, odd while it's being
+ * written, so that readers can tell whether they read a clause whole.
+ */
+class ClauseRing {
+public:
+  // Maximum number of literals of the clauses published.
+  static constexpr size_t kMaxSize = 16;
+
+  // Position of a reader in the ring.
+  using Cursor = uint64_t;
+
+  // Creates a ring holding the given number of clauses, rounded up to a power
+  // of two.
+  explicit ClauseRing(size_t capacity);
+
+  ClauseRing(const ClauseRing &) = delete;
+  ClauseRing &operator=(const ClauseRing &) = delete;
+
+  // Publishes a clause on behalf of the given source, along with its LBD.
+  // Returns false if it was dropped.
+  bool Push(int source, const Clause &, uint32_t lbd);
+
+  // Appends the clauses published by sources other than the given one since
+  // the cursor, and advances it.
+  void Pull(int source, Cursor &,
+            std::vector<std::pair<Clause, uint32_t>> &out) const;
+
+private:
+  struct Slot {
+    // 2*i+1 while clause i is being written, and 2*i+2 once written.
+    std::atomic<uint64_t> seq{0};
+    // i+1 for the latest clause i dropped because a writer of an earlier lap
+    // still held the slot, so that readers don't wait for it.
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<int> source{0};
+    std::atomic<uint32_t> lbd{0};
+    std::atomic<uint32_t> size{0};
+    std::array<std::atomic<int>, kMaxSize> lits;
+  };
+
+  size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+  // Number of clauses claimed by writers so far.
+  std::atomic<uint64_t> head_;
+};
+
+} // namespace solver
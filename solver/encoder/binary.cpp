@@ -0,0 +1,204 @@
+#include "solver/encoder/binary.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "util/log.h"
+#include "util/mapped_file.h"
+
+namespace solver {
+namespace encoder {
+
+namespace {
+
+constexpr char kMagic[4] = {'K', 'C', 'N', 'F'};
+constexpr uint32_t kVersion = 1;
+
+// Flags of the header.
+constexpr uint32_t kNames = 1 << 0;
+
+struct Header {
+  char magic[4];
+  uint32_t version;
+  uint32_t flags;
+  uint32_t n;
+  uint32_t m;
+  uint32_t reserved;
+  uint64_t numLits;
+};
+
+static_assert(sizeof(Header) == 32, "unexpected header layout");
+static_assert(sizeof(Lit) == sizeof(uint32_t),
+              "literals must be stored as they are laid out in memory");
+
+} // namespace
+
+std::string FromBinaryFile(Solver &solver, fs::path path) {
+  std::error_code ec;
+  if (!fs::exists(path, ec)) {
+    return "file " + path.string() + " does not exist";
+  }
+  util::MappedFile file;
+  if (auto err = file.Open(path.string()); !err.empty()) {
+    return err;
+  }
+  Header h;
+  if (file.size() < sizeof(h)) {
+    return "missing header";
+  }
+  std::memcpy(&h, file.data(), sizeof(h));
+  if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0) {
+    return "not a binary CNF file";
+  }
+  if (h.version != kVersion) {
+    return "unsupported version " + std::to_string(h.version);
+  }
+  constexpr uint32_t kMaxVar = std::numeric_limits<int>::max() / 2 - 1;
+  if (h.n > kMaxVar) {
+    return "invalid number of variables: n=" + std::to_string(h.n);
+  }
+
+  // The mapping is page-aligned and every section has a size multiple of its
+  // alignment, so the sections can be accessed in place.
+  const size_t size = file.size();
+  const size_t offsetsBytes =
+      (static_cast<size_t>(h.m) + 1) * sizeof(uint64_t);
+  if (h.numLits > (size - sizeof(h)) / sizeof(uint32_t) ||
+      offsetsBytes > size - sizeof(h) - h.numLits * sizeof(uint32_t)) {
+    return "truncated file";
+  }
+  const auto *offsets =
+      reinterpret_cast<const uint64_t *>(file.data() + sizeof(h));
+  const auto *lits = reinterpret_cast<const uint32_t *>(
+      file.data() + sizeof(h) + offsetsBytes);
+  const char *names = reinterpret_cast<const char *>(lits + h.numLits);
+  const char *end = file.data() + size;
+
+  if (offsets[0] != 0 || offsets[h.m] != h.numLits) {
+    return "invalid clause offsets";
+  }
+  for (uint32_t i = 0; i < h.m; ++i) {
+    if (offsets[i] > offsets[i + 1]) {
+      return "invalid clause offsets";
+    }
+  }
+  for (uint64_t i = 0; i < h.numLits; ++i) {
+    if (lits[i] < 2 || lits[i] >= 2 * h.n + 2) {
+      return "literal out of range: " + std::to_string(lits[i]);
+    }
+  }
+
+  // Variables keep their numbers if the solver was empty, in which case the
+  // literals are added as they are.
+  std::vector<int> vars(h.n + 1, 0);
+  bool identity = true;
+  solver.Reserve(solver.NumVars() + h.n, solver.NumClauses() + h.m,
+                 h.numLits);
+  for (uint32_t x = 1; x <= h.n; ++x) {
+    if (h.flags & kNames) {
+      if (names == end) {
+        return "truncated name table";
+      }
+      const bool temp = *names++ != 0;
+      const void *eos = std::memchr(names, '\0', end - names);
+      if (eos == nullptr) {
+        return "truncated name table";
+      }
+      const std::string_view name(names,
+                                  static_cast<const char *>(eos) - names);
+      names = static_cast<const char *>(eos) + 1;
+      if (temp != (name.find('$') != std::string_view::npos) ||
+          (!temp && name.empty())) {
+        return "invalid variable name '" + std::string(name) + "'";
+      }
+      if (temp) {
+        vars[x] = solver.RestoreTempVar(name).ID();
+      } else {
+        vars[x] = solver.NewOrGetVar(name).ID();
+      }
+    } else {
+      vars[x] = solver.NewOrGetVar(std::to_string(x)).ID();
+    }
+    identity = identity && vars[x] == static_cast<int>(x);
+  }
+
+  Clause clause;
+  for (uint32_t i = 0; i < h.m; ++i) {
+    const uint32_t *first = lits + offsets[i];
+    const uint32_t *last = lits + offsets[i + 1];
+    if (identity) {
+      solver.AddClause(reinterpret_cast<const Lit *>(first), last - first);
+      continue;
+    }
+    clause.clear();
+    for (const uint32_t *l = first; l != last; ++l) {
+      clause.push_back(Lit(2 * vars[*l >> 1] + (*l & 1)));
+    }
+    solver.AddClause(clause);
+  }
+
+  return "";
+}
+
+std::string ToBinaryFile(Solver &solver, fs::path path) {
+  std::ofstream out(path, std::ios::binary);
+  if (!out.is_open()) {
+    return "failed to create " + path.string();
+  }
+
+  const auto &clauses = solver.GetClauses();
+  std::vector<uint64_t> offsets{0};
+  offsets.reserve(solver.NumClauses() + 1);
+  for (const auto c : clauses) {
+    offsets.push_back(offsets.back() + c.size());
+  }
+
+  // Variables named by their number are anonymous.
+  bool numbered = true;
+  for (int x = 1; x <= solver.NumVars() && numbered; ++x) {
+    numbered = solver.IsAnonymous(x);
+  }
+
+  Header h;
+  std::memcpy(h.magic, kMagic, sizeof(kMagic));
+  h.version = kVersion;
+  h.flags = numbered ? 0 : kNames;
+  h.n = solver.NumVars();
+  h.m = solver.NumClauses();
+  h.reserved = 0;
+  h.numLits = offsets.back();
+  out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+  out.write(reinterpret_cast<const char *>(offsets.data()),
+            offsets.size() * sizeof(uint64_t));
+  for (const auto c : clauses) {
+    out.write(reinterpret_cast<const char *>(c.begin()),
+              c.size() * sizeof(uint32_t));
+  }
+  if (!numbered) {
+    for (int x = 1; x <= solver.NumVars(); ++x) {
+      const std::string name = solver.NameOf(x);
+      out.put(solver.IsTemp(x) ? 1 : 0);
+      out.write(name.c_str(), name.size() + 1);
+    }
+  }
+
+  if (!out.good()) {
+    return "failed to write " + path.string();
+  }
+  return "";
+}
+
+bool IsBinaryFile(fs::path path) {
+  std::ifstream in(path, std::ios::binary);
+  char magic[sizeof(kMagic)];
+  return in.read(magic, sizeof(magic)) &&
+         std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+}
+
+} // namespace encoder
+} // namespace solver
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+#include "solver/solver.h"
+
+namespace solver {
+namespace encoder {
+
+namespace fs = std::filesystem;
+
+/*
+ * Instance encoder for an instance stored in a binary CNF file, as written by
+ * ToBinaryFile. Binary files are memory mapped and their literals are copied
+ * into the solver as they are, so reading them is much faster than parsing an
+ * equivalent DIMACS file.
+ *
+ * All values are stored in native byte order, laid out as follows:
+ *
+ *   header:   magic "KCNF", version, flags, n, m (uint32 each), numLits
+ *             (uint64), padded to 32 bytes.
+ *   offsets:  m + 1 uint64 offsets of the clauses in the literals section.
+ *   literals: numLits uint32 literals, using the solver representation, i.e.
+ *             2x for x and 2x+1 for ¬x.
+ *   names:    only if bit 0 of flags is set. For each variable, a byte telling
+ *             whether it's temporary followed by its NUL-terminated name.
+ *             Otherwise, variables are named by number as in DIMACS.
+ *
+ * Temporary variables get back their names, unless they're taken in the
+ * solver, in which case they're renamed as by Solver::NewTempVar.
+ */
+std::string FromBinaryFile(Solver &, fs::path);
+
+/*
+ * Encoder to write an existing solver's instance to a binary CNF file. The
+ * name table is only written if any variable isn't named by its number.
+ */
+std::string ToBinaryFile(Solver &, fs::path);
+
+// Returns whether the file at path starts like a binary CNF file.
+bool IsBinaryFile(fs::path);
+
+} // namespace encoder
+} // namespace solver
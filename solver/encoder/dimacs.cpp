@@ -1,31 +1,107 @@
 #include "solver/encoder/dimacs.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <cstring>
 #include <fstream>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "util/decompressed_file.h"
 #include "util/log.h"
+#include "util/mapped_file.h"
 
 namespace solver {
 namespace encoder {
 
-std::string FromDimacsFile(Solver &solver, fs::path path) {
-  std::error_code ec;
-  if (!fs::exists(path, ec)) {
-    return "file " + path.string() + " does not exist";
-  }
-  std::ifstream in(path);
-  if (!in.is_open()) {
-    return "failed to open " + path.string();
+namespace {
+
+// Files smaller than this are parsed by a single thread.
+constexpr size_t kMinChunkBytes = 1 << 20;
+
+// Clause literals parsed from a chunk of a DIMACS file, as they appear in the
+// file, i.e. as signed variable numbers with 0 terminating each clause.
+struct Chunk {
+  std::vector<int> lits;
+  std::string err;
+  bool end = false; // whether the chunk contains the '%' end marker.
+};
+
+// Parses the clauses in [p, end), which must start at the beginning of a line.
+void ParseChunk(const char *p, const char *end, Chunk &chunk) {
+  constexpr int kMaxVar = std::numeric_limits<int>::max() / 2 - 1;
+  chunk.lits.reserve((end - p) / 4);
+  while (p < end) {
+    const char c = *p;
+    if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+      ++p;
+      continue;
+    }
+    if (c == 'c') {
+      const void *eol = std::memchr(p, '\n', end - p);
+      p = eol ? static_cast<const char *>(eol) : end;
+      continue;
+    }
+    // Some benchmarks mark the end of the clauses with a '%' line.
+    if (c == '%') {
+      chunk.end = true;
+      return;
+    }
+    const bool neg = c == '-';
+    if (neg) {
+      ++p;
+    }
+    if (p == end) {
+      chunk.err = "unexpected end of file";
+      return;
+    }
+    if (*p < '0' || *p > '9') {
+      chunk.err = "unexpected character '" + std::string(p, 1) + "' in clause";
+      return;
+    }
+    int x = 0;
+    for (; p < end && '0' <= *p && *p <= '9'; ++p) {
+      x = 10 * x + (*p - '0');
+      if (x > kMaxVar) {
+        chunk.err = "variable out of range";
+        return;
+      }
+    }
+    if (p < end && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r') {
+      chunk.err = "unexpected character '" + std::string(p, 1) + "' in clause";
+      return;
+    }
+    chunk.lits.push_back(neg ? -x : x);
   }
+}
 
-  int n = 0;
-  int m = 0;
-  std::string line;
+// Parses the comments and the problem line at the beginning of [p, end), and
+// advances p past them. Unless last is set, more input might follow, so a line
+// not terminated yet sets partial instead of being parsed.
+std::string ParseHeader(const char *&p, const char *end, bool last, int &n,
+                        int &m, bool &partial) {
   std::string format;
-  for (std::string line; std::getline(in, line);) {
+  while (format.empty()) {
+    while (p < end && std::isspace(static_cast<unsigned char>(*p))) {
+      ++p;
+    }
+    const char *eol = static_cast<const char *>(std::memchr(p, '\n', end - p));
+    if (eol == nullptr && !last) {
+      partial = true;
+      return "";
+    }
+    if (p == end) {
+      return "missing problem line";
+    }
+    eol = eol ? eol : end;
+    const std::string line(p, eol);
+    p = eol;
     std::stringstream lin(line);
     char typ;
     lin >> typ;
@@ -48,25 +124,203 @@ std::string FromDimacsFile(Solver &solver, fs::path path) {
     default:
       return "unexpected line '" + line + "'";
     }
-    if (!format.empty()) {
+  }
+  return "";
+}
+
+// Adds the clauses parsed from consecutive chunks to a solver. Variables are
+// numbered as in the file, and instances are usually dense, so the n variables
+// announced by the header are created upfront.
+class Builder {
+public:
+  Builder(Solver &solver, int n) : solver_(solver), vars_{0} {
+    vars_.reserve(n + 1);
+    Var(n);
+  }
+
+  void Add(const std::vector<int> &lits) {
+    for (const int lit : lits) {
+      if (lit == 0) {
+        solver_.AddClause(clause_);
+        clause_.clear();
+        ++numClauses_;
+      } else {
+        const int x = Var(std::abs(lit));
+        clause_.push_back(Lit(2 * x + (lit < 0)));
+      }
+    }
+  }
+
+  // Adds the last clause, which might lack its terminating 0.
+  void Finish() {
+    if (!clause_.empty()) {
+      solver_.AddClause(clause_);
+      clause_.clear();
+      ++numClauses_;
+    }
+  }
+
+  // Checks that the number of clauses read is the one of the header.
+  std::string Check(int m) const {
+    if (numClauses_ != m) {
+      return "expected " + std::to_string(m) + " clauses, read " +
+             std::to_string(numClauses_);
+    }
+    return "";
+  }
+
+private:
+  Solver &solver_;
+  std::vector<int> vars_;
+  Clause clause_;
+  int numClauses_ = 0;
+
+  int Var(int x) {
+    while (static_cast<int>(vars_.size()) <= x) {
+      vars_.push_back(
+          solver_.NewOrGetVar(std::to_string(static_cast<int>(vars_.size())))
+              .ID());
+    }
+    return vars_[x];
+  }
+};
+
+// Reads a compressed DIMACS file, parsing the decompressed data as it's
+// produced by a background thread.
+std::string FromCompressedDimacsFile(Solver &solver, const fs::path &path,
+                                     util::Compression compression) {
+  util::DecompressedFile file;
+  if (auto err = file.Open(path.string(), compression); !err.empty()) {
+    return err;
+  }
+  std::string buf;
+  std::string block;
+  bool more = true;
+  auto Read = [&]() {
+    more = file.Next(block);
+    if (more) {
+      buf += block;
+    }
+    return more || file.Error().empty();
+  };
+
+  // Read until the header is complete.
+  int n = 0;
+  int m = 0;
+  for (;;) {
+    const char *p = buf.data();
+    bool partial = false;
+    auto err = ParseHeader(p, buf.data() + buf.size(), !more, n, m, partial);
+    if (!partial) {
+      if (!err.empty()) {
+        return err;
+      }
+      buf.erase(0, p - buf.data());
+      break;
+    }
+    if (!Read()) {
+      return file.Error();
+    }
+  }
+
+  solver.Reserve(solver.NumVars() + n, solver.NumClauses() + m, 0);
+  Builder builder(solver, n);
+  Chunk chunk;
+  for (;;) {
+    // Parse the complete lines, keeping the last one for later unless the end
+    // of the data was reached.
+    size_t len = buf.size();
+    if (more) {
+      const size_t eol = buf.rfind('\n');
+      len = eol == std::string::npos ? 0 : eol + 1;
+    }
+    chunk.lits.clear();
+    ParseChunk(buf.data(), buf.data() + len, chunk);
+    if (!chunk.err.empty()) {
+      return chunk.err;
+    }
+    builder.Add(chunk.lits);
+    if (chunk.end || !more) {
       break;
     }
+    buf.erase(0, len);
+    if (!Read()) {
+      return file.Error();
+    }
   }
+  builder.Finish();
+
+  return builder.Check(m);
+}
 
-read_clauses:
-  for (int i = 0; i < m; ++i) {
-    std::vector<Lit> clause;
-    for (int lit = 0; in >> lit;) {
-      if (lit == 0)
-        break;
-      Var x = solver.NewOrGetVar(std::to_string(abs(lit)));
-      clause.push_back(lit > 0 ? x : ~x);
+} // namespace
+
+std::string FromDimacsFile(Solver &solver, fs::path path) {
+  std::error_code ec;
+  if (!fs::exists(path, ec)) {
+    return "file " + path.string() + " does not exist";
+  }
+  if (auto compression = util::DetectCompression(path.string());
+      compression != util::Compression::kNone) {
+    return FromCompressedDimacsFile(solver, path, compression);
+  }
+  util::MappedFile file;
+  if (auto err = file.Open(path.string()); !err.empty()) {
+    return err;
+  }
+  const char *p = file.data();
+  const char *end = file.data() + file.size();
+
+  int n = 0;
+  int m = 0;
+  bool partial = false;
+  if (auto err = ParseHeader(p, end, true, n, m, partial); !err.empty()) {
+    return err;
+  }
+
+  // Split the clauses into chunks at line boundaries, and parse them in
+  // parallel.
+  const size_t len = end - p;
+  const size_t numChunks = std::max<size_t>(
+      1, std::min<size_t>(std::thread::hardware_concurrency(),
+                          len / kMinChunkBytes));
+  std::vector<const char *> bounds{p};
+  for (size_t i = 1; i < numChunks; ++i) {
+    const char *q = std::max(bounds.back(), p + i * len / numChunks);
+    const void *eol = std::memchr(q, '\n', end - q);
+    bounds.push_back(eol ? static_cast<const char *>(eol) + 1 : end);
+  }
+  bounds.push_back(end);
+  std::vector<Chunk> chunks(numChunks);
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < numChunks; ++i) {
+    threads.emplace_back(ParseChunk, bounds[i], bounds[i + 1],
+                         std::ref(chunks[i]));
+  }
+  ParseChunk(bounds[0], bounds[1], chunks[0]);
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  size_t numLits = 0;
+  for (const auto &chunk : chunks) {
+    numLits += chunk.lits.size();
+  }
+  solver.Reserve(solver.NumVars() + n, solver.NumClauses() + m, numLits);
+  Builder builder(solver, n);
+  for (auto &chunk : chunks) {
+    if (!chunk.err.empty()) {
+      return chunk.err;
+    }
+    builder.Add(chunk.lits);
+    chunk.lits = std::vector<int>();
+    if (chunk.end) {
+      break;
     }
-    solver.AddClause(clause);
-    clause.clear();
   }
+  builder.Finish();
 
-  return "";
+  return builder.Check(m);
 }
 
 std::string ToDimacsFile(Solver &solver, fs::path path) {
@@ -74,11 +328,19 @@ std::string ToDimacsFile(Solver &solver, fs::path path) {
   if (!out.is_open()) {
     return "failed to create " + path.string();
   }
-  out << "c Variable names:\n";
-  for (const auto &name : solver.GetVarNames()) {
-    Var x = solver.GetVar(name);
-    out << "c \t" << std::setw(9) << x.ID() << " " << std::setw(18) << name
-        << " temp=" << solver.IsTemp(x) << '\n';
+  // Anonymous variables are named by their number already.
+  bool named = false;
+  for (int i = 1; i <= solver.NumVars(); ++i) {
+    Var x(i);
+    if (solver.IsAnonymous(x)) {
+      continue;
+    }
+    if (!named) {
+      out << "c Variable names:\n";
+      named = true;
+    }
+    out << "c \t" << std::setw(9) << x.ID() << " " << std::setw(18)
+        << solver.NameOf(x) << " temp=" << solver.IsTemp(x) << '\n';
   }
   out << "p cnf " << solver.NumVars() << " " << solver.NumClauses() << '\n';
   for (const auto &c : solver.GetClauses()) {
@@ -90,5 +352,33 @@ std::string ToDimacsFile(Solver &solver, fs::path path) {
   return "";
 }
 
+std::string ToICNFFile(Solver &solver,
+                       const std::vector<std::vector<Lit>> &cubes,
+                       fs::path path) {
+  std::ofstream out(path);
+  if (!out.is_open()) {
+    return "failed to create " + path.string();
+  }
+  out << "p inccnf\n";
+  for (const auto &c : solver.GetClauses()) {
+    for (const auto &l : c) {
+      out << (l.IsPos() ? l.V().ID() : -l.V().ID()) << ' ';
+    }
+    out << "0\n";
+  }
+  for (const auto &cube : cubes) {
+    out << 'a';
+    for (const auto &l : cube) {
+      out << ' ' << (l.IsPos() ? l.V().ID() : -l.V().ID());
+    }
+    out << " 0\n";
+  }
+  out.close();
+  if (out.fail()) {
+    return "failed to write " + path.string();
+  }
+  return "";
+}
+
 } // namespace encoder
 } // namespace solver
@@ -2,6 +2,7 @@
 
 #include <filesystem>
 #include <string>
+#include <vector>
 
 #include "solver/solver.h"
 
@@ -11,7 +12,12 @@ namespace encoder {
 namespace fs = std::filesystem;
 
 /*
- * Instance encoder for an instance stored in a DIMACS format file.
+ * Instance encoder for an instance stored in a DIMACS format file. Files
+ * compressed with gzip, xz or bzip2 are decompressed on the fly, as detected by
+ * their magic bytes or extension.
+ *
+ * Clauses are read up to the end of the file or a line starting with '%', and
+ * there must be as many as announced by the header.
  *
  * @see: https://www.cs.ubc.ca/~hoos/SATLIB/Benchmarks/SAT/satformat.ps
  */
@@ -24,5 +30,15 @@ std::string FromDimacsFile(Solver &, fs::path);
  */
 std::string ToDimacsFile(Solver &, fs::path);
 
+/*
+ * Encoder to write an existing solver's instance to an iCNF format file, along
+ * with cubes to solve it under, e.g. those split by a lookahead. Each cube is
+ * written as a line of assumptions, e.g. "a 1 -2 0".
+ *
+ * @see: https://www.siert.nl/icnf/
+ */
+std::string ToICNFFile(Solver &, const std::vector<std::vector<Lit>> &cubes,
+                       fs::path);
+
 } // namespace encoder
 } // namespace solver
@@ -1,6 +1,7 @@
 #include "minimal_implicant.h"
 
 #include <algorithm>
+#include <array>
 
 #include "solver/encoder/cardinality.h"
 #include "solver/encoder/circuit.h"
@@ -0,0 +1,61 @@
+#include "solver/encoder/model_writer.h"
+
+#include <charconv>
+
+namespace solver {
+namespace encoder {
+
+namespace {
+
+// Buffered output is written once it grows beyond this.
+constexpr size_t kFlushBytes = 1 << 20;
+
+} // namespace
+
+std::string ModelWriter::Open(fs::path path) {
+  Close();
+  out_.open(path, std::ios::binary);
+  if (!out_.is_open()) {
+    return "failed to create " + path.string();
+  }
+  path_ = path;
+  count_ = 0;
+  return "";
+}
+
+bool ModelWriter::Write(const Assignment &model) {
+  if (!out_.is_open()) {
+    return false;
+  }
+  char num[16];
+  buf_ += "v";
+  for (const Lit lit : model) {
+    const int x = lit.IsPos() ? lit.VID() : -lit.VID();
+    buf_ += ' ';
+    buf_.append(num, std::to_chars(num, num + sizeof(num), x).ptr);
+  }
+  buf_ += " 0\n";
+  ++count_;
+  return buf_.size() < kFlushBytes || Flush();
+}
+
+std::string ModelWriter::Close() {
+  if (!out_.is_open()) {
+    return "";
+  }
+  const bool ok = Flush();
+  out_.close();
+  if (!ok || out_.fail()) {
+    return "failed to write " + path_.string();
+  }
+  return "";
+}
+
+bool ModelWriter::Flush() {
+  out_.write(buf_.data(), buf_.size());
+  buf_.clear();
+  return out_.good();
+}
+
+} // namespace encoder
+} // namespace solver
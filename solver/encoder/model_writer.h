@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "solver/solver.h"
+
+namespace solver {
+namespace encoder {
+
+namespace fs = std::filesystem;
+
+/*
+ * Writes satisfying assignments to a file as they're found, so that
+ * enumerating them doesn't need to keep them in memory. Each assignment is
+ * written as a DIMACS value line, e.g. "v 1 -2 3 0", and the lines are
+ * buffered and written in large blocks.
+ *
+ * Write has the signature of a Solver::ModelFn, so that it can be used as:
+ *
+ *   solver.SolveAll([&](const Assignment &a) { return writer.Write(a); });
+ */
+class ModelWriter {
+public:
+  ModelWriter() : count_(0) {}
+  ~ModelWriter() { Close(); }
+
+  ModelWriter(const ModelWriter &) = delete;
+  ModelWriter &operator=(const ModelWriter &) = delete;
+
+  // Creates the file at path, replacing any file opened before. Returns an
+  // error message on failure, or an empty string otherwise.
+  std::string Open(fs::path);
+
+  // Appends an assignment. Returns false if the file couldn't be written.
+  bool Write(const Assignment &);
+
+  // Writes what's still buffered and closes the file. Returns an error message
+  // if any write failed, or an empty string otherwise.
+  std::string Close();
+
+  // Number of assignments written since the file was opened.
+  size_t Count() const { return count_; }
+
+private:
+  std::ofstream out_;
+  std::string buf_;
+  size_t count_;
+  fs::path path_;
+
+  bool Flush();
+};
+
+} // namespace encoder
+} // namespace solver
@@ -1,4 +1,4 @@
-#include "solver/encoder/sample.h"
+#include "solver/encoder/sudoku.h"
 
 #include "solver/encoder/cardinality.h"
 
@@ -0,0 +1,207 @@
+#include "solver/local_search.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "util/log.h"
+
+namespace solver {
+
+namespace {
+
+// Break counts above this are weighted like it by probSAT.
+constexpr int kMaxBreak = 64;
+
+// Weight of flipping a variable given its break count in probSAT, with the
+// parameters suggested for each clause length: polynomial for 3SAT, and
+// exponential for longer clauses.
+std::vector<double> ProbSATWeights(int maxSize) {
+  std::vector<double> weights(kMaxBreak + 1);
+  for (int b = 0; b <= kMaxBreak; ++b) {
+    if (maxSize <= 3) {
+      weights[b] = std::pow(1.0 + b, -2.38);
+    } else {
+      const double cb = maxSize == 4 ? 3.0 : maxSize == 5 ? 3.7 : 5.1;
+      weights[b] = std::pow(cb, -b);
+    }
+  }
+  return weights;
+}
+
+} // namespace
+
+LocalSearch::Instance::Instance(int n) : n(n), OSTART(2 * n + 3, 0) {}
+
+void LocalSearch::Instance::Add(Clause clause) {
+  if (!Normalize(clause)) {
+    return;
+  }
+  empty = empty || clause.empty();
+  maxSize = std::max(maxSize, static_cast<int>(clause.size()));
+  for (const Lit l : clause) {
+    LITS.push_back(l.ID());
+    ++OSTART[l.ID() + 1];
+  }
+  START.push_back(static_cast<int>(LITS.size()));
+}
+
+void LocalSearch::Instance::Index() {
+  for (size_t l = 1; l < OSTART.size(); ++l) {
+    OSTART[l] += OSTART[l - 1];
+  }
+  OCC.resize(LITS.size());
+  std::vector<int> next(OSTART.begin(), OSTART.end() - 1);
+  for (int j = 0; j < NumClauses(); ++j) {
+    for (int i = START[j]; i < START[j + 1]; ++i) {
+      OCC[next[LITS[i]]++] = j;
+    }
+  }
+}
+
+LocalSearch::LocalSearch(const Instance &in, Mode mode, double noise,
+                         uint32_t seed, const std::vector<char> &values)
+    : in_(in), mode_(mode), noise_(noise), rng_(seed), VAL(in.n + 1),
+      NUMTRUE(in.NumClauses(), 0), TRUEXOR(in.NumClauses(), 0),
+      BREAK(in.n + 1, 0), WHERE(in.NumClauses(), -1),
+      inChanged_(in.n + 1, 0) {
+  CHECK(static_cast<int>(in.OCC.size()) == in.START.back())
+      << "the instance should be indexed";
+  if (mode == Mode::kProbSAT) {
+    weights_ = ProbSATWeights(in.maxSize);
+  }
+  if (values.empty()) {
+    std::bernoulli_distribution coin;
+    for (int x = 1; x <= in.n; ++x) {
+      VAL[x] = coin(rng_);
+    }
+  } else {
+    CHECK(static_cast<int>(values.size()) == in.n + 1)
+        << "expected values for variables 1.." << in.n;
+    VAL = values;
+  }
+  for (int j = 0; j < in.NumClauses(); ++j) {
+    for (int i = in.START[j]; i < in.START[j + 1]; ++i) {
+      if (IsTrue(in.LITS[i])) {
+        ++NUMTRUE[j];
+        TRUEXOR[j] ^= in.LITS[i];
+      }
+    }
+    if (NUMTRUE[j] == 0) {
+      AddUnsat(j);
+    } else if (NUMTRUE[j] == 1) {
+      ++BREAK[TRUEXOR[j] >> 1];
+    }
+  }
+  BEST = VAL;
+  bestUnsat_ = UNSAT.size();
+}
+
+void LocalSearch::AddUnsat(int j) {
+  WHERE[j] = static_cast<int>(UNSAT.size());
+  UNSAT.push_back(j);
+}
+
+void LocalSearch::RemoveUnsat(int j) {
+  const int last = UNSAT.back();
+  UNSAT[WHERE[j]] = last;
+  WHERE[last] = WHERE[j];
+  UNSAT.pop_back();
+}
+
+void LocalSearch::Flip(int x) {
+  VAL[x] = !VAL[x];
+  if (!inChanged_[x]) {
+    inChanged_[x] = 1;
+    CHANGED.push_back(x);
+  }
+  const int t = VAL[x] ? 2 * x : 2 * x + 1;
+  const int f = t ^ 1;
+  for (int i = in_.OSTART[t]; i < in_.OSTART[t + 1]; ++i) {
+    const int j = in_.OCC[i];
+    TRUEXOR[j] ^= t;
+    if (++NUMTRUE[j] == 1) {
+      RemoveUnsat(j);
+      ++BREAK[x];
+    } else if (NUMTRUE[j] == 2) {
+      --BREAK[(TRUEXOR[j] ^ t) >> 1];
+    }
+  }
+  for (int i = in_.OSTART[f]; i < in_.OSTART[f + 1]; ++i) {
+    const int j = in_.OCC[i];
+    TRUEXOR[j] ^= f;
+    if (--NUMTRUE[j] == 0) {
+      AddUnsat(j);
+      --BREAK[x];
+    } else if (NUMTRUE[j] == 1) {
+      ++BREAK[TRUEXOR[j] >> 1];
+    }
+  }
+}
+
+int LocalSearch::Pick(int j) {
+  const int begin = in_.START[j];
+  const int size = in_.START[j + 1] - begin;
+  if (mode_ == Mode::kProbSAT) {
+    cumulative_.clear();
+    double sum = 0;
+    for (int i = 0; i < size; ++i) {
+      sum += weights_[std::min(BREAK[in_.LITS[begin + i] >> 1], kMaxBreak)];
+      cumulative_.push_back(sum);
+    }
+    const double r = std::uniform_real_distribution<>(0, sum)(rng_);
+    const int i = static_cast<int>(
+        std::upper_bound(cumulative_.begin(), cumulative_.end(), r) -
+        cumulative_.begin());
+    return in_.LITS[begin + std::min(i, size - 1)] >> 1;
+  }
+
+  // Least break count, breaking ties at random.
+  int best = 0;
+  int ties = 0;
+  for (int i = 0; i < size; ++i) {
+    const int x = in_.LITS[begin + i] >> 1;
+    if (BREAK[x] == 0) {
+      return x;
+    }
+    const int b = BREAK[in_.LITS[begin + best] >> 1];
+    if (i == 0 || BREAK[x] < b) {
+      best = i;
+      ties = 1;
+    } else if (BREAK[x] == b &&
+               std::uniform_int_distribution<>(0, ties++)(rng_) == 0) {
+      best = i;
+    }
+  }
+  if (std::bernoulli_distribution(noise_)(rng_)) {
+    best = std::uniform_int_distribution<>(0, size - 1)(rng_);
+  }
+  return in_.LITS[begin + best] >> 1;
+}
+
+bool LocalSearch::Run(int64_t flips) {
+  for (int64_t i = 0; i < flips && !UNSAT.empty(); ++i) {
+    const int j = UNSAT[std::uniform_int_distribution<>(
+        0, static_cast<int>(UNSAT.size()) - 1)(rng_)];
+    Flip(Pick(j));
+    ++flips_;
+    if (UNSAT.size() < bestUnsat_) {
+      bestUnsat_ = UNSAT.size();
+      for (const int x : CHANGED) {
+        BEST[x] = VAL[x];
+        inChanged_[x] = 0;
+      }
+      CHANGED.clear();
+    }
+  }
+  return UNSAT.empty();
+}
+
+Assignment LocalSearch::Model() const {
+  Assignment sol;
+  for (int x = 1; x <= in_.n; ++x) {
+    sol.push_back(VAL[x] ? Lit(Var(x)) : ~Var(x));
+  }
+  return sol;
+}
+
+} // namespace solver
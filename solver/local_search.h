@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "solver/solver.h"
+
+namespace solver {
+
+/*
+ * A walk of stochastic local search over the assignments of a set of clauses:
+ * repeatedly picks an unsatisfied clause at random and flips one of its
+ * variables. The unsatisfied clauses are kept in a set with O(1) insertion and
+ * deletion, and each variable has its break count, i.e. the number of clauses
+ * that flipping it would falsify, updated incrementally after each flip.
+ *
+ * WalkSAT flips a variable with a zero break count if there's one, or else a
+ * random one with probability p, or else one with the least break count. The
+ * probSAT variant flips each variable with probability proportional to a
+ * decreasing function of its break count instead.
+ *
+ * The walk also keeps the values with the fewest unsatisfied clauses it went
+ * through, by recording the variables flipped since it last improved on them.
+ */
+class LocalSearch {
+public:
+  enum class Mode {
+    kWalkSAT,
+    kProbSAT,
+  };
+
+  // The clauses, without repeated literals nor tautologies, laid out for walks
+  // to share.
+  //
+  // LITS[START[j]..START[j+1]-1] = literal IDs of clause j.
+  // OCC[OSTART[l]..OSTART[l+1]-1] = clauses with literal l.
+  struct Instance {
+    // Creates an instance over variables 1..n.
+    explicit Instance(int n);
+
+    // Adds a clause, without its repeated literals, unless it's a tautology.
+    void Add(Clause clause);
+    // Lays out the occurrences of the literals, once every clause is added.
+    void Index();
+
+    int NumClauses() const { return static_cast<int>(START.size()) - 1; }
+
+    int n;
+    int maxSize = 0;
+    bool empty = false;
+    std::vector<int> LITS;
+    std::vector<int> START{0};
+    std::vector<int> OCC;
+    std::vector<int> OSTART;
+  };
+
+  // Starts a walk on an indexed instance from the given values of variables
+  // 1..n, or from random ones if none are given.
+  LocalSearch(const Instance &in, Mode mode, double noise, uint32_t seed,
+              const std::vector<char> &values = {});
+
+  // Flips up to the given number of variables, stopping early once every
+  // clause is satisfied. Returns whether they all are.
+  bool Run(int64_t flips);
+
+  size_t NumUnsat() const { return UNSAT.size(); }
+  int64_t NumFlips() const { return flips_; }
+  size_t BestUnsat() const { return bestUnsat_; }
+
+  // Values of variables 1..n, at index 1..n, with the fewest unsatisfied
+  // clauses so far.
+  const std::vector<char> &Best() const { return BEST; }
+
+  // Current values of the variables.
+  Assignment Model() const;
+
+private:
+  bool IsTrue(int l) const { return VAL[l >> 1] != (l & 1); }
+  void AddUnsat(int j);
+  void RemoveUnsat(int j);
+  void Flip(int x);
+  int Pick(int j);
+
+  const Instance &in_;
+  const Mode mode_;
+  const double noise_;
+  std::mt19937 rng_;
+
+  // VAL[x]      = current value of variable x.
+  // NUMTRUE[j]  = number of true literals in clause j.
+  // TRUEXOR[j]  = XOR of the true literals of clause j, i.e. the true literal
+  //               if it's the only one.
+  // BREAK[x]    = number of clauses whose only true literal is on x.
+  // UNSAT       = clauses with no true literal, in any order.
+  // WHERE[j]    = position of clause j in UNSAT, if it's there.
+  // BEST[x]     = value of x when the fewest clauses were unsatisfied.
+  // CHANGED     = variables flipped since then, once each, whose BEST value
+  //               is updated when the walk improves on it.
+  std::vector<char> VAL;
+  std::vector<int> NUMTRUE;
+  std::vector<int> TRUEXOR;
+  std::vector<int> BREAK;
+  std::vector<int> UNSAT;
+  std::vector<int> WHERE;
+  std::vector<char> BEST;
+  std::vector<char> inChanged_;
+  std::vector<int> CHANGED;
+  size_t bestUnsat_;
+  int64_t flips_ = 0;
+  std::vector<double> weights_;
+  std::vector<double> cumulative_;
+};
+
+} // namespace solver
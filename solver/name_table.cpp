@@ -0,0 +1,97 @@
+#include "solver/name_table.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+
+namespace solver {
+
+// Returns the variable ID written in decimal in name, or 0 if name is not the
+// canonical representation of one.
+static int ParseID(std::string_view name) {
+  constexpr int kMaxID = std::numeric_limits<int>::max() / 2 - 1;
+  if (name.empty() || name.size() > 10 || name[0] < '1' || name[0] > '9') {
+    return 0;
+  }
+  int64_t x = 0;
+  for (char c : name) {
+    if (c < '0' || c > '9') {
+      return 0;
+    }
+    x = 10 * x + (c - '0');
+  }
+  return x <= kMaxID ? static_cast<int>(x) : 0;
+}
+
+void NameTable::Add(std::string_view name) {
+  std::string primed;
+  if (name.empty() || ParseID(name) == Size() + 1) {
+    // The variable is named after its ID, unless that's already the name of
+    // another one, in which case primes are appended until it's unique.
+    primed = std::to_string(Size() + 1);
+    if (Find(primed) == 0) {
+      end_.push_back(end_.back());
+      return;
+    }
+    do {
+      primed += '\'';
+    } while (Find(primed) != 0);
+    name = primed;
+  }
+  chars_.insert(chars_.end(), name.begin(), name.end());
+  end_.push_back(static_cast<uint32_t>(chars_.size()));
+  if (2 * (named_ + 1) > static_cast<int>(slots_.size())) {
+    Rehash(std::max<size_t>(16, 2 * slots_.size()));
+  }
+  const size_t mask = slots_.size() - 1;
+  size_t i = std::hash<std::string_view>()(name) & mask;
+  while (slots_[i] != 0) {
+    i = (i + 1) & mask;
+  }
+  slots_[i] = Size();
+  ++named_;
+}
+
+int NameTable::Find(std::string_view name) const {
+  if (!slots_.empty()) {
+    const size_t mask = slots_.size() - 1;
+    for (size_t i = std::hash<std::string_view>()(name) & mask; slots_[i] != 0;
+         i = (i + 1) & mask) {
+      if (View(slots_[i]) == name) {
+        return slots_[i];
+      }
+    }
+  }
+  const int x = ParseID(name);
+  return x > 0 && x <= Size() && IsAnonymous(x) ? x : 0;
+}
+
+std::string NameTable::Get(int x) const {
+  return IsAnonymous(x) ? std::to_string(x) : std::string(View(x));
+}
+
+void NameTable::Clear() {
+  chars_.clear();
+  end_.assign(1, 0);
+  slots_.clear();
+  named_ = 0;
+}
+
+void NameTable::Rehash(size_t capacity) {
+  slots_.assign(capacity, 0);
+  const size_t mask = capacity - 1;
+  for (int x = 1; x <= Size(); ++x) {
+    if (IsAnonymous(x)) {
+      continue;
+    }
+    size_t i = std::hash<std::string_view>()(View(x)) & mask;
+    while (slots_[i] != 0) {
+      i = (i + 1) & mask;
+    }
+    slots_[i] = x;
+  }
+}
+
+} // namespace solver
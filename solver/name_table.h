@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace solver {
+
+/*
+ * Interned variable names.
+ *
+ * Names are stored back to back in a single buffer, in variable order, and
+ * indexed by an open-addressing hash table of variable IDs, so adding a name
+ * costs a few bytes and no allocation besides growing the buffers.
+ *
+ * Variables may also be anonymous, in which case nothing is stored but their
+ * position and their name is their ID, generated on demand. A variable named
+ * after its own ID, as e.g. those read from DIMACS files, is stored as
+ * anonymous. If its ID is already the name of an earlier variable, it's named
+ * after its ID followed by as many primes as needed to keep names unique.
+ */
+class NameTable {
+public:
+  NameTable() : end_{0}, named_(0) {}
+
+  // Adds the next variable with the given name, or anonymous if empty.
+  void Add(std::string_view name);
+
+  // Returns the ID of the variable with the given name, or 0 if there's none.
+  int Find(std::string_view name) const;
+
+  // Returns the name of variable x.
+  std::string Get(int x) const;
+
+  bool IsAnonymous(int x) const { return end_[x - 1] == end_[x]; }
+
+  int Size() const { return static_cast<int>(end_.size()) - 1; }
+
+  void Reserve(int n) { end_.reserve(n + 1); }
+
+  void Clear();
+
+private:
+  // Names of the variables, where variable x is named [end_[x-1], end_[x]).
+  std::vector<char> chars_;
+  std::vector<uint32_t> end_;
+  // Hash table of named variables, with 0 marking empty slots.
+  std::vector<int> slots_;
+  int named_;
+
+  std::string_view View(int x) const {
+    return std::string_view(chars_.data() + end_[x - 1],
+                            end_[x] - end_[x - 1]);
+  }
+  void Rehash(size_t capacity);
+};
+
+} // namespace solver
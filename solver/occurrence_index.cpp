@@ -0,0 +1,71 @@
+#include "solver/occurrence_index.h"
+
+#include <algorithm>
+
+#include "solver/solver.h"
+
+namespace solver {
+
+void OccurrenceIndex::Sync(const ClauseArena &arena, int numVars) {
+  if (generation_ != arena.Generation()) {
+    Clear();
+    generation_ = arena.Generation();
+  }
+  const size_t numLits = 2 * static_cast<size_t>(numVars) + 2;
+  if (start_.size() < numLits + 1) {
+    start_.resize(numLits + 1, start_.empty() ? 0 : start_.back());
+  }
+  const auto &refs = arena.Refs();
+  if (synced_ == refs.size()) {
+    return;
+  }
+
+  // pos[l] = number of new occurrences of literals before l.
+  std::vector<size_t> pos(numLits + 1, 0);
+  for (size_t i = synced_; i < refs.size(); ++i) {
+    const auto c = arena[refs[i]];
+    if (c.Learned() || c.Header().deleted) {
+      continue;
+    }
+    for (const Lit lit : c) {
+      ++pos[lit.ID() + 1];
+    }
+  }
+  for (size_t l = 1; l <= numLits; ++l) {
+    pos[l] += pos[l - 1];
+  }
+
+  // Shift the old occurrences of each literal to make room for the new ones
+  // right after them. Going from the last literal to the first, every range is
+  // moved towards the end before its destination is overwritten.
+  size_t end = start_[numLits];
+  occ_.resize(end + pos[numLits]);
+  start_[numLits] = occ_.size();
+  for (size_t l = numLits; l-- > 0;) {
+    const size_t first = start_[l];
+    std::copy_backward(occ_.begin() + first, occ_.begin() + end,
+                       occ_.begin() + end + pos[l]);
+    start_[l] = first + pos[l];
+    // The new occurrences of l go right after the old ones.
+    pos[l] += end;
+    end = first;
+  }
+  for (; synced_ < refs.size(); ++synced_) {
+    const CRef cr = refs[synced_];
+    const auto c = arena[cr];
+    if (c.Learned() || c.Header().deleted) {
+      continue;
+    }
+    for (const Lit lit : c) {
+      occ_[pos[lit.ID()]++] = cr;
+    }
+  }
+}
+
+void OccurrenceIndex::Clear() {
+  start_.clear();
+  occ_.clear();
+  synced_ = 0;
+}
+
+} // namespace solver
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "solver/clause_arena.h"
+
+namespace solver {
+
+/*
+ * Index of the clauses in which each literal occurs, in compressed sparse row
+ * form: the references of the clauses containing literal l are stored
+ * contiguously in allocation order, starting at start_[l].
+ *
+ * Only original clauses are indexed, not learned ones. The index is brought
+ * up to date lazily by Sync: clauses allocated since the last call are merged
+ * in with a single pass over the index, without visiting the clauses already
+ * indexed, and it's only rebuilt from scratch if the arena invalidated its
+ * references in the meantime.
+ */
+class OccurrenceIndex {
+public:
+  // Clause references of the occurrences of a literal.
+  class View {
+  public:
+    View(const CRef *first, const CRef *last) : first_(first), last_(last) {}
+
+    const CRef *begin() const { return first_; }
+    const CRef *end() const { return last_; }
+    size_t size() const { return last_ - first_; }
+    bool empty() const { return first_ == last_; }
+    CRef operator[](size_t i) const { return first_[i]; }
+
+  private:
+    const CRef *first_;
+    const CRef *last_;
+  };
+
+  OccurrenceIndex() : synced_(0), generation_(0) {}
+
+  // Brings the index up to date with the clauses in the arena, over the given
+  // number of variables.
+  void Sync(const ClauseArena &, int numVars);
+
+  // Occurrences of the literal with the given ID, which must be a literal of
+  // one of the variables the index was last synced with.
+  View Occurrences(int l) const {
+    return View(occ_.data() + start_[l], occ_.data() + start_[l + 1]);
+  }
+
+  // Number of occurrences of the literal with the given ID.
+  size_t Count(int l) const { return start_[l + 1] - start_[l]; }
+
+  void Clear();
+
+private:
+  // Occurrences of literal l are occ_[start_[l]] to occ_[start_[l+1]-1].
+  std::vector<size_t> start_;
+  std::vector<CRef> occ_;
+  // Number of arena references already indexed, and the arena generation they
+  // belong to.
+  size_t synced_;
+  uint64_t generation_;
+};
+
+} // namespace solver
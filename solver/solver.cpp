@@ -1,8 +1,13 @@
 #include "solver.h"
 
+#include <algorithm>
+#include <cstdio>
 #include <set>
 #include <sstream>
 
+#include <sys/resource.h>
+#include <unistd.h>
+
 namespace solver {
 
 // A prefix used for temporary variables, which can't be used in ordinary
@@ -27,68 +32,203 @@ bool Lit::operator<(const Lit &that) const { return this->l < that.l; }
 Lit Lit::operator~() const { return Lit(l ^ 1); }
 Var Lit::V() const { return Var(l >> 1); }
 
-Solver::Solver() : n_(0), tmpID_(0) {}
+bool Normalize(Clause &clause) {
+  std::sort(clause.begin(), clause.end());
+  clause.erase(std::unique(clause.begin(), clause.end()), clause.end());
+  for (size_t i = 1; i < clause.size(); ++i) {
+    if (clause[i] == ~clause[i - 1]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Solver::Solver()
+    : n_(0), tmpID_(0), terminate_(false), checks_(0), revision_(0) {}
 
-Var Solver::NewTempVar(std::string prefix) {
+Var Solver::NewTempVar(std::string_view prefix) {
   CHECK(prefix.find(kTmpSep) == std::string::npos)
       << "variable prefixes are not allowed to contain '" << kTmpSep << "'";
-  while (nameToVar_.count(prefix + kTmpSep + std::to_string(tmpID_))) {
-    ++tmpID_;
+  do {
+    tmpName_.assign(prefix);
+    tmpName_ += kTmpSep;
+    tmpName_ += std::to_string(tmpID_++);
+  } while (names_.Find(tmpName_) != 0);
+  names_.Add(tmpName_);
+  ++n_;
+  ++revision_;
+  isTemp_.push_back(true);
+  return Var(n_);
+}
+
+Var Solver::RestoreTempVar(std::string_view name) {
+  const size_t sep = name.find(kTmpSep);
+  CHECK(sep != std::string::npos)
+      << "temporary variable names must contain '" << kTmpSep << "'";
+  if (names_.Find(name) != 0) {
+    return NewTempVar(name.substr(0, sep));
   }
-  std::string name = prefix + kTmpSep + std::to_string(tmpID_++);
-  name_.push_back(name);
+  names_.Add(name);
+  ++n_;
+  ++revision_;
+  isTemp_.push_back(true);
+  return Var(n_);
+}
+
+Var Solver::NewVar() {
+  names_.Add("");
   ++n_;
-  Var x(n_);
-  nameToVar_.emplace(name, x);
-  isTemp_.emplace_back(true);
-  return x;
+  ++revision_;
+  isTemp_.push_back(false);
+  return Var(n_);
 }
 
-Var Solver::NewVar(std::string name) {
+Var Solver::NewVar(std::string_view name) {
   CHECK(name.find(kTmpSep) == std::string::npos)
       << "variable names are not allowed to contain '" << kTmpSep << "'";
   CHECK(!name.empty()) << "variable name cannot be empty";
-  CHECK(nameToVar_.count(name) == 0)
-      << "duplicate variable name '" << name << "'";
-  name_.push_back(name);
+  CHECK(names_.Find(name) == 0) << "duplicate variable name '" << name << "'";
+  names_.Add(name);
   ++n_;
-  Var x(n_);
-  nameToVar_.emplace(name, x);
-  isTemp_.emplace_back(false);
-  return x;
+  ++revision_;
+  isTemp_.push_back(false);
+  return Var(n_);
 }
 
-Var Solver::NewOrGetVar(std::string name) {
-  if (nameToVar_.count(name)) {
-    return nameToVar_.at(name);
-  } else {
-    return NewVar(name);
+Var Solver::NewOrGetVar(std::string_view name) {
+  if (int x = names_.Find(name); x != 0) {
+    return Var(x);
   }
+  return NewVar(name);
 }
 
-Var Solver::GetVar(std::string name) const {
-  CHECK(nameToVar_.count(name) > 0) << "unknown variable name '" << name << "'";
-  return nameToVar_.at(name);
+Var Solver::GetVar(std::string_view name) const {
+  const int x = names_.Find(name);
+  CHECK(x != 0) << "unknown variable name '" << name << "'";
+  return Var(x);
 }
 
-const std::vector<std::string> &Solver::GetVarNames() const { return name_; }
+std::vector<std::string> Solver::GetVarNames() const {
+  std::vector<std::string> names;
+  names.reserve(n_);
+  for (int x = 1; x <= n_; ++x) {
+    names.push_back(names_.Get(x));
+  }
+  return names;
+}
+
+const ClauseArena &Solver::GetClauses() const { return clauses_; }
 
-const std::vector<std::vector<Lit>> &Solver::GetClauses() const {
-  return clauses_;
+const OccurrenceIndex &Solver::Occurrences() {
+  occ_.Sync(clauses_, n_);
+  return occ_;
 }
 
-std::string Solver::NameOf(Var x) const { return name_[x.ID() - 1]; }
+std::string Solver::NameOf(Var x) const { return names_.Get(x.ID()); }
 
 bool Solver::IsTemp(Var x) const { return isTemp_[x.ID() - 1]; }
 
-void Solver::AddClause(std::vector<Lit> c) { clauses_.emplace_back(c); }
+bool Solver::IsAnonymous(Var x) const { return names_.IsAnonymous(x.ID()); }
+
+void Solver::AddClause(const std::vector<Lit> &c) {
+  clauses_.Alloc(c.data(), c.size());
+  ++revision_;
+}
+
+void Solver::AddClause(const Lit *lits, size_t size) {
+  clauses_.Alloc(lits, size);
+  ++revision_;
+}
+
+// Returns the resident memory of the process in bytes.
+static size_t ResidentMemory() {
+  long pages = 0;
+  if (FILE *f = std::fopen("/proc/self/statm", "r")) {
+    if (std::fscanf(f, "%*s %ld", &pages) != 1) {
+      pages = 0;
+    }
+    std::fclose(f);
+  }
+  if (pages > 0) {
+    return static_cast<size_t>(pages) * sysconf(_SC_PAGESIZE);
+  }
+  // Fall back to the peak resident memory, in bytes on macOS and in kilobytes
+  // elsewhere.
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return static_cast<size_t>(usage.ru_maxrss);
+#else
+  return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+Result Solver::SolveAll(const ModelFn &fn) {
+  auto [res, sols] = SolveAll();
+  for (const auto &sol : sols) {
+    if (!fn(sol)) {
+      break;
+    }
+  }
+  return res;
+}
+
+void Solver::StartSearch() {
+  usage_ = Resources();
+  start_ = std::chrono::steady_clock::now();
+  checks_ = 0;
+}
+
+bool Solver::Interrupted(int64_t conflicts, int64_t propagations) {
+  // Checking the clock, the memory and the terminate function is expensive,
+  // so it's only done every so often.
+  constexpr uint32_t kCheckPeriod = 256;
+
+  usage_.conflicts = conflicts;
+  usage_.propagations = propagations;
+  bool stop = (terminate_.load(std::memory_order_relaxed) &&
+               terminate_.exchange(false)) ||
+              (budget_.conflicts > 0 && conflicts >= budget_.conflicts) ||
+              (budget_.propagations > 0 &&
+               propagations >= budget_.propagations);
+  if (stop || checks_++ % kCheckPeriod == 0) {
+    usage_.seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start_)
+                         .count();
+    // Reading the memory takes a system call or two, so it's only done
+    // under a memory budget.
+    if (budget_.memoryBytes > 0) {
+      usage_.memoryBytes = ResidentMemory();
+    }
+    stop = stop || (budget_.seconds > 0 && usage_.seconds >= budget_.seconds) ||
+           (budget_.memoryBytes > 0 &&
+            usage_.memoryBytes >= budget_.memoryBytes) ||
+           (terminateFn_ && terminateFn_());
+  }
+  if (stop) {
+    LOG << "search interrupted: conflicts=" << usage_.conflicts
+        << " propagations=" << usage_.propagations
+        << " seconds=" << usage_.seconds << " memory=" << usage_.memoryBytes;
+  }
+  return stop;
+}
+
+// Reserves memory for the given number of variables, clauses and literals,
+// e.g. as announced by the header of a file about to be read.
+void Solver::Reserve(int numVars, int numClauses, size_t numLits) {
+  names_.Reserve(numVars);
+  isTemp_.reserve(numVars);
+  clauses_.Reserve(numClauses, numLits);
+}
 
 void Solver::Reset() {
   n_ = 0;
-  name_.clear();
-  clauses_.clear();
-  nameToVar_.clear();
+  names_.Clear();
+  clauses_.Clear();
   tmpID_ = 0;
+  isTemp_.clear();
+  occ_.Clear();
+  ++revision_;
 }
 
 bool Solver::Verify(const std::vector<Lit> &solution,
@@ -103,7 +243,7 @@ bool Solver::Verify(const std::vector<Lit> &solution,
     }
     used[lit.ID()] = true;
   }
-  for (auto clause : clauses_) {
+  for (const auto clause : clauses_) {
     bool ok = false;
     for (auto lit : clause) {
       if (used[lit.ID()]) {
@@ -121,35 +261,45 @@ bool Solver::Verify(const std::vector<Lit> &solution,
   return true;
 }
 
-std::string Solver::ToString(Var x) const { return name_[x.ID() - 1]; }
+std::string Solver::ToString(Var x) const { return NameOf(x); }
 
 std::string Solver::ToString(Lit l) const {
   std::string s = NameOf(l.V());
   return (l != l.V()) ? "¬" + s : s;
 }
 
-std::string Solver::ToString(const std::vector<Lit> &lits, std::string sep,
-                             bool raw) const {
+// Joins the given literals into a string, using sep as separator and either the
+// variable names or their raw DIMACS representation.
+template <typename It>
+static std::string JoinLits(const Solver &solver, It first, It last,
+                            const std::string &sep, bool raw) {
   std::stringstream out;
-  bool first = true;
-  for (auto l : lits) {
-    if (!first) {
+  for (It it = first; it != last; ++it) {
+    if (it != first) {
       out << sep;
     }
-    first = false;
     if (raw) {
-      out << (l.IsNeg() ? "-" : "") << l.V().ID();
+      out << (it->IsNeg() ? "-" : "") << it->V().ID();
     } else {
-      out << ToString(l);
+      out << solver.ToString(*it);
     }
   }
   return out.str();
 }
 
+std::string Solver::ToString(const std::vector<Lit> &lits, std::string sep,
+                             bool raw) const {
+  return JoinLits(*this, lits.begin(), lits.end(), sep, raw);
+}
+
+std::string Solver::ToString(ConstClauseView c) const {
+  return JoinLits(*this, c.begin(), c.end(), ", ", false);
+}
+
 std::string Solver::ToString() const {
   std::stringstream out;
   bool first = true;
-  for (auto c : clauses_) {
+  for (const auto c : clauses_) {
     if (!first) {
       out << " ∧ ";
     }
@@ -1,9 +1,16 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <vector>
 
+#include "solver/clause_arena.h"
+#include "solver/name_table.h"
+#include "solver/occurrence_index.h"
 #include "util/log.h"
 
 namespace solver {
@@ -47,47 +54,124 @@ private:
 using Assignment = std::vector<Lit>;
 using Clause = std::vector<Lit>;
 
+// Sorts the literals of a clause and removes the repeated ones. Returns false
+// if the clause is a tautology, i.e. contains a literal and its negation.
+bool Normalize(Clause &clause);
+
 enum class Result {
   kSAT,
   kUNSAT,
   kUnknown,
 };
 
+// Resources used by a single call to Solve or SolveAll. When used as a budget,
+// zero means unlimited. The memory used is only measured under a memory
+// budget.
+struct Resources {
+  int64_t conflicts = 0;
+  int64_t propagations = 0;
+  double seconds = 0;
+  size_t memoryBytes = 0;
+};
+
 class Solver {
 public:
+  // Function called by SolveAll with each satisfying assignment as soon as
+  // it's found. The search stops as soon as it returns false.
+  using ModelFn = std::function<bool(const Assignment &)>;
+
   Solver();
   virtual ~Solver() {}
 
-  void Reset();
-  Var NewVar(std::string);
-  Var NewTempVar(std::string = "t");
-  Var NewOrGetVar(std::string);
-  Var GetVar(std::string) const;
+  virtual void Reset();
+  // Creates an anonymous variable, whose name is its ID, e.g. "42".
+  Var NewVar();
+  Var NewVar(std::string_view);
+  Var NewTempVar(std::string_view = "t");
+  // Creates a temporary variable with the given name, as given by NameOf for
+  // a temporary variable, e.g. when reading it back from a file. If the name
+  // is taken, the variable is named as by NewTempVar with the same prefix.
+  Var RestoreTempVar(std::string_view name);
+  Var NewOrGetVar(std::string_view);
+  Var GetVar(std::string_view) const;
   std::string NameOf(Var) const;
   bool IsTemp(Var) const;
-  void AddClause(Clause);
+  bool IsAnonymous(Var) const;
+  void AddClause(const Clause &);
+  void AddClause(const Lit *lits, size_t size);
+  void Reserve(int numVars, int numClauses, size_t numLits);
   int NumVars() const { return n_; }
-  int NumClauses() const { return static_cast<int>(clauses_.size()); }
-  const std::vector<std::string> &GetVarNames() const;
-  const std::vector<Clause> &GetClauses() const;
+  int NumClauses() const { return clauses_.NumClauses(); }
+  std::vector<std::string> GetVarNames() const;
+  const ClauseArena &GetClauses() const;
+  // Index of the original clauses in which each literal occurs, brought up to
+  // date with the clauses added so far.
+  const OccurrenceIndex &Occurrences();
   bool Verify(const Assignment &, std::string * = nullptr) const;
   std::string ToString(Var) const;
   std::string ToString(Lit) const;
   std::string ToString(const Assignment &lits, std::string sep = ", ",
                        bool raw = false) const;
+  std::string ToString(ConstClauseView) const;
   std::string ToString() const;
 
   virtual std::pair<Result, Assignment> Solve() = 0;
   virtual std::pair<Result, std::vector<Assignment>> SolveAll() = 0;
+  // Streams every satisfying assignment to the given function instead of
+  // keeping them all, and returns kSAT if there was any, even if stopped by the
+  // function. Algorithms that can't stream them hand over those returned by
+  // SolveAll once it's done.
+  virtual Result SolveAll(const ModelFn &);
   virtual std::string ID() const = 0;
 
+  // Limits the resources of every call to Solve or SolveAll, which gives up
+  // and returns kUnknown once any of them is exhausted.
+  void SetBudget(const Resources &budget) { budget_ = budget; }
+
+  // Resources used by the last call to Solve or SolveAll, as last sampled
+  // while it was running.
+  const Resources &GetUsage() const { return usage_; }
+
+  // Asks the current or next call to Solve or SolveAll to give up as soon as
+  // possible and return kUnknown. It's safe to call from any thread or from a
+  // signal handler.
+  void Terminate() { terminate_ = true; }
+
+  // Sets a function polled periodically while solving. As soon as it returns
+  // true, the search is given up as if Terminate was called.
+  void SetTerminate(std::function<bool()> fn) { terminateFn_ = std::move(fn); }
+
 protected:
   int n_;
-  std::vector<std::string> name_;
-  std::vector<Clause> clauses_;
-  std::unordered_map<std::string, Var> nameToVar_;
+  NameTable names_;
+  ClauseArena clauses_;
   int tmpID_;
   std::vector<bool> isTemp_;
+  OccurrenceIndex occ_;
+
+  // Starts accounting the resources of a new call to Solve or SolveAll.
+  void StartSearch();
+
+  // Counter increased by every change to the variables or to the clauses
+  // added with AddClause, so that algorithms can reuse what they compile from
+  // the instance between calls.
+  uint64_t Revision() const { return revision_; }
+
+  // Checks whether the search must be given up, given the number of conflicts
+  // and propagations so far. Algorithms call it at points where returning
+  // kUnknown is safe.
+  bool Interrupted(int64_t conflicts = 0, int64_t propagations = 0);
+
+private:
+  Resources budget_;
+  Resources usage_;
+  std::atomic<bool> terminate_;
+  std::function<bool()> terminateFn_;
+  std::chrono::steady_clock::time_point start_;
+  uint32_t checks_;
+  uint64_t revision_;
+  // Buffer reused to build the names of temporary variables.
+  std::string tmpName_;
 };
 
 } // namespace solver
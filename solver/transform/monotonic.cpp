@@ -12,7 +12,7 @@ void Monotonic(Solver &solver) {
   [[maybe_unused]] const int n0 = solver.NumVars();
   [[maybe_unused]] const int m0 = solver.NumClauses();
   std::vector<std::string> names = solver.GetVarNames();
-  std::vector<std::vector<Lit>> clauses = solver.GetClauses();
+  ClauseArena clauses = solver.GetClauses();
 
   solver.Reset();
   std::vector<Var> posVars;
@@ -24,7 +24,7 @@ void Monotonic(Solver &solver) {
     negVars.push_back(x1);
     solver.AddClause({~x0, ~x1});
   }
-  for (auto clause : clauses) {
+  for (const auto clause : clauses) {
     std::vector<Lit> newClause;
     for (auto l : clause) {
       if (l.IsNeg()) {
@@ -10,14 +10,15 @@ namespace transform {
 
 void SAT3(Solver &solver) {
   std::vector<std::string> names = solver.GetVarNames();
-  std::vector<std::vector<Lit>> clauses = solver.GetClauses();
+  ClauseArena clauses = solver.GetClauses();
 
   solver.Reset();
   for (auto name : names) {
     solver.NewVar(name);
   }
-  for (auto clause : clauses) {
-    solver::encoder::AtLeast(solver, clause, 1);
+  for (const auto clause : clauses) {
+    solver::encoder::AtLeast(solver, Clause(clause.begin(), clause.end()),
+                             1);
   }
 }
 
@@ -1,8 +1,19 @@
+#include <fstream>
+#include <random>
+#include <sstream>
+
+#include <bzlib.h>
+#include <lzma.h>
+#include <zlib.h>
+
 #include "gtest/gtest.h"
 
 #include "solver/algorithm/algorithm.h"
+#include "solver/encoder/binary.h"
 #include "solver/encoder/cardinality.h"
+#include "solver/encoder/dimacs.h"
 #include "solver/encoder/encoder.h"
+#include "solver/encoder/model_writer.h"
 #include "solver/encoder/waerden.h"
 
 TEST(EncoderTest, CardinalityExactlyOne) {
@@ -100,3 +111,232 @@ TEST(EncoderTest, Waerden) {
     }
   }
 }
+
+TEST(EncoderTest, Dimacs) {
+  const auto path = std::filesystem::temp_directory_path() / "dimacs_test.cnf";
+  {
+    std::ofstream out(path);
+    out << "c a comment\n"
+        << "p cnf 4 3\n"
+        << "1 -2 0\n"
+        << "c another comment\n"
+        << "2 3\n"
+        << "  -4 0 -1\n"
+        << "%\n"
+        << "0\n";
+  }
+  solver::algorithm::Nop solver;
+  EXPECT_EQ(solver::encoder::FromDimacsFile(solver, path), "");
+  // Variables are numbered as in the file, including unused ones, and the
+  // last clause doesn't need a terminating 0.
+  EXPECT_EQ(solver.NumVars(), 4);
+  EXPECT_EQ(solver.NumClauses(), 3);
+  EXPECT_EQ(solver.ToString(), "(1 ∨ ¬2) ∧ (2 ∨ 3 ∨ ¬4) ∧ (¬1)");
+
+  {
+    std::ofstream out(path);
+    out << "p cnf 2 1\n1 x 0\n";
+  }
+  solver::algorithm::Nop bad;
+  EXPECT_NE(solver::encoder::FromDimacsFile(bad, path), "");
+
+  // The header must announce as many clauses as there are.
+  for (const char *clauses : {"1 0\n", "1 0\n2 0\n-1 -2 0\n"}) {
+    {
+      std::ofstream out(path);
+      out << "p cnf 2 2\n" << clauses;
+    }
+    solver::algorithm::Nop wrong;
+    EXPECT_NE(solver::encoder::FromDimacsFile(wrong, path), "") << clauses;
+  }
+  std::filesystem::remove(path);
+}
+
+TEST(EncoderTest, DimacsRoundTrip) {
+  const auto path = std::filesystem::temp_directory_path() / "waerden.cnf";
+  solver::algorithm::C original;
+  solver::encoder::Waerden(original, 3, 3, 9);
+  EXPECT_EQ(solver::encoder::ToDimacsFile(original, path), "");
+
+  solver::algorithm::C solver;
+  EXPECT_EQ(solver::encoder::FromDimacsFile(solver, path), "");
+  EXPECT_EQ(solver.NumVars(), original.NumVars());
+  EXPECT_EQ(solver.NumClauses(), original.NumClauses());
+  EXPECT_EQ(solver.Solve().first, solver::Result::kUNSAT);
+  std::filesystem::remove(path);
+}
+
+
+TEST(EncoderTest, BinaryRoundTrip) {
+  const auto path = std::filesystem::temp_directory_path() / "waerden.kcnf";
+  solver::algorithm::C original;
+  solver::encoder::Waerden(original, 3, 3, 9);
+  EXPECT_EQ(solver::encoder::ToBinaryFile(original, path), "");
+  EXPECT_TRUE(solver::encoder::IsBinaryFile(path));
+
+  solver::algorithm::C solver;
+  EXPECT_EQ(solver::encoder::FromBinaryFile(solver, path), "");
+  EXPECT_EQ(solver.GetVarNames(), original.GetVarNames());
+  EXPECT_EQ(solver.ToString(), original.ToString());
+  EXPECT_EQ(solver.Solve().first, solver::Result::kUNSAT);
+  std::filesystem::remove(path);
+}
+
+TEST(EncoderTest, BinaryTempNames) {
+  const auto path = std::filesystem::temp_directory_path() / "temp.kcnf";
+  solver::algorithm::Nop original;
+  const solver::Lit a = original.NewVar("a");
+  const solver::Lit t = original.NewTempVar();
+  const solver::Lit u = original.NewTempVar("u");
+  original.AddClause({a, t, ~u});
+  EXPECT_EQ(solver::encoder::ToBinaryFile(original, path), "");
+
+  // Temporary variables keep their names, even after others were created.
+  solver::algorithm::Nop solver;
+  solver.NewTempVar("x");
+  EXPECT_EQ(solver::encoder::FromBinaryFile(solver, path), "");
+  EXPECT_EQ(solver.GetVarNames(),
+            (std::vector<std::string>{"x$0", "a", "t$0", "u$1"}));
+  EXPECT_TRUE(solver.IsTemp(solver::Var(3)));
+  EXPECT_NE(solver.NewTempVar(), solver::Var(3));
+
+  // Names that are taken are replaced.
+  EXPECT_EQ(solver::encoder::FromBinaryFile(solver, path), "");
+  EXPECT_EQ(solver.NumVars(), 7);
+  EXPECT_EQ(solver.NameOf(solver::Var(6)).substr(0, 2), "t$");
+  EXPECT_NE(solver.NameOf(solver::Var(6)), "t$0");
+  std::filesystem::remove(path);
+}
+
+TEST(EncoderTest, BinaryFromDimacs) {
+  const auto cnf = std::filesystem::temp_directory_path() / "binary_test.cnf";
+  const auto kcnf = std::filesystem::temp_directory_path() / "binary_test.kcnf";
+  {
+    std::ofstream out(cnf);
+    out << "p cnf 4 3\n1 -2 0\n2 3 -4 0\n-1 0\n";
+  }
+  solver::algorithm::Nop original;
+  EXPECT_EQ(solver::encoder::FromDimacsFile(original, cnf), "");
+  EXPECT_FALSE(solver::encoder::IsBinaryFile(cnf));
+  EXPECT_EQ(solver::encoder::ToBinaryFile(original, kcnf), "");
+
+  // Variables named by number are restored without a name table, and merged
+  // with those of a non-empty solver.
+  solver::algorithm::Nop solver;
+  solver.NewVar("2");
+  EXPECT_EQ(solver::encoder::FromBinaryFile(solver, kcnf), "");
+  EXPECT_EQ(solver.NumVars(), 4);
+  EXPECT_EQ(solver.ToString(), "(1 ∨ ¬2) ∧ (2 ∨ 3 ∨ ¬4) ∧ (¬1)");
+
+  solver::algorithm::Nop bad;
+  EXPECT_NE(solver::encoder::FromBinaryFile(bad, cnf), "");
+  std::filesystem::remove(cnf);
+  std::filesystem::remove(kcnf);
+}
+
+TEST(EncoderTest, DimacsCompressed) {
+  // Large enough to span several blocks of decompressed data.
+  std::mt19937 rng(1);
+  std::stringstream text;
+  text << "c random 3-CNF\np cnf 1000 200000\n";
+  for (int i = 0; i < 200000; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      text << (rng() % 2 ? "-" : "") << 1 + rng() % 1000 << ' ';
+    }
+    text << "0\n";
+  }
+  const std::string data = text.str();
+
+  const auto dir = std::filesystem::temp_directory_path();
+  const auto cnf = dir / "compressed_test.cnf";
+  std::ofstream(cnf) << data;
+  solver::algorithm::Nop plain;
+  EXPECT_EQ(solver::encoder::FromDimacsFile(plain, cnf), "");
+  EXPECT_EQ(plain.NumClauses(), 200000);
+
+  auto Check = [&](const std::filesystem::path &path,
+                   const std::string &compressed) {
+    std::ofstream(path, std::ios::binary) << compressed;
+    solver::algorithm::Nop solver;
+    EXPECT_EQ(solver::encoder::FromDimacsFile(solver, path), "") << path;
+    EXPECT_EQ(solver.ToString(), plain.ToString()) << path;
+
+    // Truncated files are reported as errors.
+    std::ofstream(path, std::ios::binary)
+        << compressed.substr(0, compressed.size() / 2);
+    solver::algorithm::Nop truncated;
+    EXPECT_NE(solver::encoder::FromDimacsFile(truncated, path), "") << path;
+    std::filesystem::remove(path);
+  };
+
+  // Two concatenated gzip members.
+  const auto gz = dir / "compressed_test.cnf.gz";
+  for (const auto &part : {data.substr(0, data.size() / 3),
+                           data.substr(data.size() / 3)}) {
+    gzFile f = gzopen(gz.c_str(), "ab");
+    gzwrite(f, part.data(), part.size());
+    gzclose(f);
+  }
+  {
+    std::ifstream in(gz, std::ios::binary);
+    Check(gz, std::string(std::istreambuf_iterator<char>(in), {}));
+  }
+
+  std::string xz(lzma_stream_buffer_bound(data.size()), '\0');
+  size_t xzSize = 0;
+  ASSERT_EQ(lzma_easy_buffer_encode(
+                1, LZMA_CHECK_CRC64, nullptr,
+                reinterpret_cast<const uint8_t *>(data.data()), data.size(),
+                reinterpret_cast<uint8_t *>(xz.data()), &xzSize, xz.size()),
+            LZMA_OK);
+  Check(dir / "compressed_test.cnf.xz", xz.substr(0, xzSize));
+
+  std::string bz2(data.size() + data.size() / 100 + 600, '\0');
+  auto bz2Size = static_cast<unsigned int>(bz2.size());
+  ASSERT_EQ(BZ2_bzBuffToBuffCompress(bz2.data(), &bz2Size,
+                                     const_cast<char *>(data.data()),
+                                     data.size(), 1, 0, 0),
+            BZ_OK);
+  Check(dir / "compressed_test.cnf.bz2", bz2.substr(0, bz2Size));
+
+  std::filesystem::remove(cnf);
+}
+
+TEST(EncoderTest, ICNF) {
+  const auto path = std::filesystem::temp_directory_path() / "cubes.icnf";
+  solver::algorithm::Nop solver;
+  solver::Var x = solver.NewVar();
+  solver::Var y = solver.NewVar();
+  solver.AddClause({x, ~y});
+  solver.AddClause({y});
+  EXPECT_EQ(solver::encoder::ToICNFFile(solver, {{x}, {~x, y}, {}}, path), "");
+
+  std::ifstream in(path);
+  std::stringstream icnf;
+  icnf << in.rdbuf();
+  EXPECT_EQ(icnf.str(), "p inccnf\n1 -2 0\n2 0\na 1 0\na -1 2 0\na 0\n");
+  std::filesystem::remove(path);
+}
+
+TEST(EncoderTest, ModelWriter) {
+  const auto path = std::filesystem::temp_directory_path() / "models.txt";
+  solver::algorithm::B solver;
+  solver::Var x = solver.NewVar("x");
+  solver::Var y = solver.NewVar("y");
+  solver.AddClause({x, y});
+
+  solver::encoder::ModelWriter writer;
+  EXPECT_EQ(writer.Open(path), "");
+  EXPECT_EQ(solver.SolveAll([&](const solver::Assignment &sol) {
+    return writer.Write(sol);
+  }),
+            solver::Result::kSAT);
+  EXPECT_EQ(writer.Close(), "");
+  EXPECT_EQ(writer.Count(), 3);
+
+  std::ifstream in(path);
+  std::stringstream models;
+  models << in.rdbuf();
+  EXPECT_EQ(models.str(), "v 1 -2 0\nv 1 2 0\nv -1 2 0\n");
+  std::filesystem::remove(path);
+}
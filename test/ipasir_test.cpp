@@ -0,0 +1,61 @@
+#include "gtest/gtest.h"
+
+#include "ipasir/ipasir.h"
+
+TEST(IpasirTest, Incremental) {
+  void *s = ipasir_init();
+  // (x1 ∨ x2) ∧ (¬x1 ∨ x3) ∧ (¬x2 ∨ x3)
+  for (int lit : {1, 2, 0, -1, 3, 0, -2, 3, 0}) {
+    ipasir_add(s, lit);
+  }
+  ASSERT_EQ(ipasir_solve(s), 10);
+  EXPECT_EQ(ipasir_val(s, 3), 3);
+  EXPECT_EQ(ipasir_val(s, -3), 3);
+
+  ipasir_assume(s, -3);
+  ASSERT_EQ(ipasir_solve(s), 20);
+  EXPECT_EQ(ipasir_failed(s, -3), 1);
+  EXPECT_EQ(ipasir_failed(s, 3), 0);
+
+  // Assumptions only hold for a single call.
+  ASSERT_EQ(ipasir_solve(s), 10);
+
+  ipasir_add(s, -3);
+  ipasir_add(s, 0);
+  ASSERT_EQ(ipasir_solve(s), 20);
+  EXPECT_EQ(ipasir_failed(s, -3), 0);
+  ipasir_release(s);
+}
+
+TEST(IpasirTest, ComplementaryAssumptions) {
+  void *s = ipasir_init();
+  // (x1 ∨ x2 ∨ x3), unsatisfiable only because x1 and ¬x1 are both assumed.
+  for (int lit : {1, 2, 3, 0}) {
+    ipasir_add(s, lit);
+  }
+  ipasir_assume(s, 1);
+  ipasir_assume(s, -1);
+  ASSERT_EQ(ipasir_solve(s), 20);
+  EXPECT_EQ(ipasir_failed(s, 1), 1);
+  EXPECT_EQ(ipasir_failed(s, -1), 1);
+
+  // Assuming the failed literals alone is still unsatisfiable.
+  ipasir_assume(s, 1);
+  ipasir_assume(s, -1);
+  EXPECT_EQ(ipasir_solve(s), 20);
+  ipasir_assume(s, -1);
+  EXPECT_EQ(ipasir_solve(s), 10);
+  ipasir_release(s);
+}
+
+TEST(IpasirTest, Terminate) {
+  void *s = ipasir_init();
+  ipasir_add(s, 1);
+  ipasir_add(s, 2);
+  ipasir_add(s, 0);
+  ipasir_set_terminate(s, nullptr, [](void *) { return 1; });
+  EXPECT_EQ(ipasir_solve(s), 0);
+  ipasir_set_terminate(s, nullptr, nullptr);
+  EXPECT_EQ(ipasir_solve(s), 10);
+  ipasir_release(s);
+}
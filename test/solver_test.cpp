@@ -1,9 +1,16 @@
+#include <algorithm>
 #include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <thread>
 #include <vector>
 
 #include "gtest/gtest.h"
 
 #include "solver/algorithm/algorithm.h"
+#include "solver/algorithm/race.h"
+#include "solver/clause_ring.h"
 #include "solver/encoder/anti_maximal_element.h"
 #include "solver/encoder/cardinality.h"
 #include "solver/encoder/coloring.h"
@@ -12,8 +19,11 @@
 #include "solver/encoder/langford.h"
 #include "solver/encoder/mutilated_chessboard.h"
 #include "solver/encoder/pigeonhole.h"
+#include "solver/encoder/rand.h"
 #include "solver/encoder/sample.h"
 #include "solver/encoder/waerden.h"
+#include "solver/local_search.h"
+#include "solver/name_table.h"
 
 using SolverFn = std::function<std::unique_ptr<solver::Solver>()>;
 using EncoderFn = std::function<void(solver::Solver &)>;
@@ -23,6 +33,16 @@ using SolverTestParam =
 class SATTest : public testing::TestWithParam<SolverTestParam> {};
 class UNSATTest : public testing::TestWithParam<SolverTestParam> {};
 
+// Adds the variables and clauses of from to the empty solver to.
+void CopyInstance(const solver::Solver &from, solver::Solver &to) {
+  for (int x = 1; x <= from.NumVars(); ++x) {
+    to.NewVar();
+  }
+  for (const auto c : from.GetClauses()) {
+    to.AddClause(c.begin(), c.size());
+  }
+}
+
 TEST_P(SATTest, Solve) {
   auto [solverFn, encoderP] = GetParam();
   auto [id, encoderFn] = encoderP;
@@ -56,7 +76,30 @@ INSTANTIATE_TEST_SUITE_P(
             []() { return std::make_unique<solver::algorithm::B>(); },
             []() { return std::make_unique<solver::algorithm::C>(); },
             []() { return std::make_unique<solver::algorithm::D>(); },
-            []() { return std::make_unique<solver::algorithm::I0>(); }),
+            []() { return std::make_unique<solver::algorithm::I0>(); },
+            []() { return std::make_unique<solver::algorithm::L>(); },
+            []() {
+              return std::make_unique<solver::algorithm::Parallel>(
+                  []() { return std::make_unique<solver::algorithm::B>(); },
+                  4);
+            },
+            []() {
+              return std::make_unique<solver::algorithm::Parallel>(
+                  []() { return std::make_unique<solver::algorithm::D>(); },
+                  4);
+            },
+            []() { return std::make_unique<solver::algorithm::Portfolio>(4); },
+            []() {
+              return std::make_unique<solver::algorithm::CubeAndConquer>(4);
+            },
+            []() {
+              return std::make_unique<solver::algorithm::W>(
+                  solver::algorithm::W::Mode::kWalkSAT, 2);
+            },
+            []() {
+              return std::make_unique<solver::algorithm::W>(
+                  solver::algorithm::W::Mode::kProbSAT, 2);
+            }),
         // SAT instances
         testing::Values(
             std::make_pair("Unit", [](solver::Solver &s) { enc::Unit(s); }),
@@ -124,7 +167,22 @@ INSTANTIATE_TEST_SUITE_P(
             []() { return std::make_unique<solver::algorithm::B>(); },
             []() { return std::make_unique<solver::algorithm::C>(); },
             []() { return std::make_unique<solver::algorithm::D>(); },
-            []() { return std::make_unique<solver::algorithm::I0>(); }),
+            []() { return std::make_unique<solver::algorithm::I0>(); },
+            []() { return std::make_unique<solver::algorithm::L>(); },
+            []() {
+              return std::make_unique<solver::algorithm::Parallel>(
+                  []() { return std::make_unique<solver::algorithm::B>(); },
+                  4);
+            },
+            []() {
+              return std::make_unique<solver::algorithm::Parallel>(
+                  []() { return std::make_unique<solver::algorithm::D>(); },
+                  4);
+            },
+            []() { return std::make_unique<solver::algorithm::Portfolio>(4); },
+            []() {
+              return std::make_unique<solver::algorithm::CubeAndConquer>(4);
+            }),
         // UNSAT instances
         testing::Values(
             std::make_pair("Contradiction",
@@ -192,3 +250,859 @@ INSTANTIATE_TEST_SUITE_P(
       auto id = std::get<1>(info.param).first;
       return solverFn()->ID() + "with" + id;
     });
+
+TEST(CTest, MemoryLimit) {
+  // A tiny memory limit makes every purge drop all the droppable clauses.
+  for (bool limited : {false, true}) {
+    solver::algorithm::C sat;
+    enc::Langford(sat, 8);
+    solver::algorithm::C unsat;
+    enc::Pigeonhole(unsat, 6);
+    if (limited) {
+      sat.SetMemoryLimit(1);
+      unsat.SetMemoryLimit(1);
+    }
+    auto [satRes, sol] = sat.Solve();
+    EXPECT_EQ(satRes, solver::Result::kSAT);
+    EXPECT_TRUE(sat.Verify(sol));
+    EXPECT_EQ(unsat.Solve().first, solver::Result::kUNSAT);
+  }
+}
+
+TEST(CTest, Assumptions) {
+  solver::algorithm::C c;
+  solver::Lit x1 = c.NewVar("x1");
+  solver::Lit x2 = c.NewVar("x2");
+  solver::Lit x3 = c.NewVar("x3");
+  c.AddClause({~x1, x2});
+  c.AddClause({~x2, x3});
+
+  auto [res, sol] = c.Solve({x1, ~x3});
+  EXPECT_EQ(res, solver::Result::kUNSAT);
+  EXPECT_EQ(c.Failed().size(), 2);
+
+  std::tie(res, sol) = c.Solve({x1});
+  EXPECT_EQ(res, solver::Result::kSAT);
+  EXPECT_TRUE(c.Verify(sol));
+  EXPECT_NE(std::find(sol.begin(), sol.end(), x3), sol.end());
+
+  // Clauses and variables can be added between calls.
+  solver::Lit x4 = c.NewVar("x4");
+  c.AddClause({~x3, x4});
+  c.AddClause({~x4});
+  std::tie(res, sol) = c.Solve({x2, x1});
+  EXPECT_EQ(res, solver::Result::kUNSAT);
+  EXPECT_EQ(c.Failed(), std::vector<solver::Lit>{x2});
+
+  std::tie(res, sol) = c.Solve();
+  EXPECT_EQ(res, solver::Result::kSAT);
+  EXPECT_TRUE(c.Verify(sol));
+  EXPECT_TRUE(c.Failed().empty());
+}
+
+TEST(CTest, FailedAssumptions) {
+  // Complementary assumptions are both part of the core.
+  solver::algorithm::C c;
+  solver::Lit x = c.NewVar("x");
+  solver::Lit y = c.NewVar("y");
+  solver::Lit z = c.NewVar("z");
+  c.AddClause({x, y, z});
+  EXPECT_EQ(c.Solve({x, ~x}).first, solver::Result::kUNSAT);
+  std::vector<solver::Lit> failed = c.Failed();
+  std::sort(failed.begin(), failed.end());
+  EXPECT_EQ(failed, (std::vector<solver::Lit>{x, ~x}));
+  EXPECT_EQ(c.Solve(failed).first, solver::Result::kUNSAT);
+
+  // The assumptions left out of the core aren't needed for unsatisfiability.
+  for (int i = 0; i < 50; ++i) {
+    solver::algorithm::C r;
+    r.SetSeed(i);
+    enc::Rand(r, 30, 100, 3);
+    std::vector<solver::Lit> assumptions;
+    for (int k = 1; k <= 30; k += 3) {
+      const solver::Lit lit = solver::Lit(solver::Var(k));
+      assumptions.push_back((i + k) % 2 == 0 ? lit : ~lit);
+    }
+    assumptions.push_back(~assumptions[i % assumptions.size()]);
+    if (r.Solve(assumptions).first == solver::Result::kUNSAT) {
+      const std::vector<solver::Lit> core = r.Failed();
+      EXPECT_EQ(r.Solve(core).first, solver::Result::kUNSAT)
+          << "core [" << r.ToString(core) << "] isn't unsatisfiable";
+    }
+  }
+}
+
+TEST(CTest, Incremental) {
+  // Learned clauses are kept between calls.
+  solver::algorithm::C c;
+  enc::Pigeonhole(c, 5);
+  EXPECT_EQ(c.Solve().first, solver::Result::kUNSAT);
+  EXPECT_EQ(c.Solve().first, solver::Result::kUNSAT);
+  EXPECT_TRUE(c.Failed().empty());
+}
+
+TEST(CTest, SolveAllProjected) {
+  // x0 ⊕ x1 ⊕ ... ⊕ x7 = 1 through temporary variables for the partial sums,
+  // plus a temporary variable u that's free whenever x0 = x1 = ¬x2 = ¬x3.
+  auto Encode = [](solver::Solver &s) {
+    std::vector<solver::Lit> x;
+    for (int i = 0; i < 8; ++i) {
+      x.push_back(s.NewVar());
+    }
+    solver::Lit sum = x[0];
+    for (int i = 1; i < 8; ++i) {
+      const solver::Lit t = s.NewTempVar();
+      s.AddClause({~t, sum, x[i]});
+      s.AddClause({~t, ~sum, ~x[i]});
+      s.AddClause({t, ~sum, x[i]});
+      s.AddClause({t, sum, ~x[i]});
+      sum = t;
+    }
+    s.AddClause({sum});
+    const solver::Lit u = s.NewTempVar();
+    s.AddClause({u, x[0], x[1]});
+    s.AddClause({~u, x[2], x[3]});
+  };
+  solver::algorithm::B b;
+  Encode(b);
+  std::set<solver::Assignment> want;
+  for (const auto &sol : b.SolveAll().second) {
+    solver::Assignment model;
+    for (const auto &lit : sol) {
+      if (!b.IsTemp(lit.V())) {
+        model.push_back(lit);
+      }
+    }
+    want.insert(model);
+  }
+  ASSERT_EQ(want.size(), 120);
+
+  for (bool backtrack : {false, true}) {
+    solver::algorithm::C c;
+    c.SetBacktrackOnModels(backtrack);
+    Encode(c);
+    for (int i = 0; i < 2; ++i) {
+      std::vector<solver::Assignment> got;
+      auto res = c.SolveAll([&](const solver::Assignment &model) {
+        got.push_back(model);
+        return true;
+      });
+      EXPECT_EQ(res, solver::Result::kSAT) << backtrack;
+      // Each projected model comes exactly once.
+      EXPECT_EQ(got.size(), want.size()) << backtrack;
+      EXPECT_EQ(std::set<solver::Assignment>(got.begin(), got.end()), want)
+          << backtrack;
+    }
+
+    // The blocking clauses are gone once done.
+    auto [res, sol] = c.Solve();
+    EXPECT_EQ(res, solver::Result::kSAT) << backtrack;
+    EXPECT_TRUE(c.Verify(sol)) << backtrack;
+  }
+}
+
+TEST(CTest, SolveAllReduce) {
+  // A tiny memory limit makes learned clauses be reduced every few conflicts
+  // while listing models, which mustn't keep any blocking clause around once
+  // done.
+  solver::algorithm::C c;
+  c.SetSeed(42);
+  c.SetMemoryLimit(1);
+  enc::Langford(c, 8);
+  auto [res, all] = c.SolveAll();
+  EXPECT_EQ(res, solver::Result::kSAT);
+  EXPECT_EQ(all.size(), 300);
+  EXPECT_GT(c.GetUsage().conflicts, 1000);
+  EXPECT_EQ(c.SolveAll().second.size(), all.size());
+  auto [sres, sol] = c.Solve();
+  EXPECT_EQ(sres, solver::Result::kSAT);
+  EXPECT_TRUE(c.Verify(sol));
+}
+
+TEST(CTest, Options) {
+  for (auto phase : {solver::algorithm::C::Phase::kNegative,
+                     solver::algorithm::C::Phase::kPositive,
+                     solver::algorithm::C::Phase::kRandom}) {
+    for (auto restarts : {solver::algorithm::C::Restarts::kFlush,
+                          solver::algorithm::C::Restarts::kLuby,
+                          solver::algorithm::C::Restarts::kGlucose,
+                          solver::algorithm::C::Restarts::kStable,
+                          solver::algorithm::C::Restarts::kSwitching}) {
+      for (bool rephase : {false, true}) {
+        solver::algorithm::C c;
+        c.SetSeed(42);
+        c.SetPhase(phase);
+        c.SetRestarts(restarts);
+        c.SetRephasing(rephase);
+        enc::Langford(c, 8);
+        auto [res, sol] = c.Solve();
+        EXPECT_EQ(res, solver::Result::kSAT);
+        EXPECT_TRUE(c.Verify(sol));
+
+        c.Reset();
+        enc::Pigeonhole(c, 6);
+        EXPECT_EQ(c.Solve().first, solver::Result::kUNSAT);
+      }
+    }
+  }
+}
+
+TEST(CTest, Rephasing) {
+  // Random 3SAT a bit below the threshold, where local search finds a model
+  // much sooner than the search alone. The first walk seeds the saved phases
+  // with it, so the search ends right after.
+  auto Encode = [](solver::Solver &s) {
+    std::mt19937 rng(0);
+    for (int x = 1; x <= 200; ++x) {
+      s.NewVar();
+    }
+    for (int j = 0; j < 820; ++j) {
+      solver::Clause c;
+      for (int i = 0; i < 3; ++i) {
+        const solver::Lit l = solver::Var(1 + rng() % 200);
+        c.push_back(rng() % 2 == 0 ? l : ~l);
+      }
+      s.AddClause(c);
+    }
+  };
+  solver::algorithm::C off;
+  off.SetSeed(42);
+  Encode(off);
+  EXPECT_EQ(off.Solve().first, solver::Result::kSAT);
+  EXPECT_GT(off.GetStats().conflicts, 2000);
+  EXPECT_EQ(off.GetStats().rephases, 0);
+
+  solver::algorithm::C on;
+  on.SetSeed(42);
+  on.SetRephasing(true);
+  Encode(on);
+  auto [res, sol] = on.Solve();
+  EXPECT_EQ(res, solver::Result::kSAT);
+  EXPECT_TRUE(on.Verify(sol));
+  EXPECT_EQ(on.GetStats().rephases, 1);
+  EXPECT_GT(on.GetStats().flips, 0);
+  EXPECT_LE(on.GetStats().conflicts, 1010);
+
+  // No rephasing before the first interval.
+  on.Reset();
+  enc::Langford(on, 8);
+  EXPECT_EQ(on.Solve().first, solver::Result::kSAT);
+  EXPECT_LT(on.GetStats().conflicts, 1000);
+  EXPECT_EQ(on.GetStats().rephases, 0);
+  EXPECT_EQ(on.GetStats().flips, 0);
+}
+
+TEST(CTest, ModeSwitching) {
+  // Enough conflicts for several switches between focused and stable modes.
+  solver::algorithm::C c;
+  c.SetSeed(42);
+  c.SetRestarts(solver::algorithm::C::Restarts::kSwitching);
+  enc::Pigeonhole(c, 8);
+  EXPECT_EQ(c.Solve().first, solver::Result::kUNSAT);
+  EXPECT_GT(c.GetUsage().conflicts, 4000);
+  // Modes switch after 1000, 2000 and 4000 conflicts, each time restarting.
+  EXPECT_GE(c.GetStats().switches, 3);
+  EXPECT_GE(c.GetStats().restarts, c.GetStats().switches);
+
+  // Without switching, focused mode alone restarts too.
+  c.Reset();
+  c.SetRestarts(solver::algorithm::C::Restarts::kGlucose);
+  enc::Pigeonhole(c, 8);
+  EXPECT_EQ(c.Solve().first, solver::Result::kUNSAT);
+  EXPECT_EQ(c.GetStats().switches, 0);
+  EXPECT_GT(c.GetStats().restarts, 0);
+  c.SetRestarts(solver::algorithm::C::Restarts::kSwitching);
+
+  c.Reset();
+  enc::Waerden(c, 3, 9, 76);
+  auto [res, sol] = c.Solve();
+  EXPECT_EQ(res, solver::Result::kSAT);
+  EXPECT_TRUE(c.Verify(sol));
+}
+
+TEST(CTest, ClauseSharing) {
+  // Every clause learned by one solver is imported by the other.
+  solver::algorithm::C c1;
+  solver::algorithm::C c2;
+  enc::Pigeonhole(c1, 6);
+  enc::Pigeonhole(c2, 6);
+  std::vector<solver::algorithm::C::SharedClause> shared;
+  c1.SetClauseSharing(
+      [&](const solver::Clause &c, uint32_t lbd) {
+        shared.emplace_back(c, lbd);
+      },
+      nullptr);
+  EXPECT_EQ(c1.Solve().first, solver::Result::kUNSAT);
+  EXPECT_FALSE(shared.empty());
+
+  size_t imported = 0;
+  c2.SetClauseSharing(nullptr,
+                      [&](std::vector<solver::algorithm::C::SharedClause> &out) {
+                        imported += shared.size();
+                        std::move(shared.begin(), shared.end(),
+                                  std::back_inserter(out));
+                        shared.clear();
+                      });
+  EXPECT_EQ(c2.Solve().first, solver::Result::kUNSAT);
+  EXPECT_GT(imported, 0);
+  EXPECT_LT(c2.GetUsage().conflicts, c1.GetUsage().conflicts);
+}
+
+TEST(BudgetTest, Interrupted) {
+  std::vector<std::unique_ptr<solver::Solver>> solvers;
+  solvers.push_back(std::make_unique<solver::algorithm::A>());
+  solvers.push_back(std::make_unique<solver::algorithm::A2>());
+  solvers.push_back(std::make_unique<solver::algorithm::B>());
+  solvers.push_back(std::make_unique<solver::algorithm::C>());
+  solvers.push_back(std::make_unique<solver::algorithm::D>());
+  solvers.push_back(std::make_unique<solver::algorithm::I0>());
+  solvers.push_back(std::make_unique<solver::algorithm::Z>());
+  for (auto &s : solvers) {
+    enc::Pigeonhole(*s, 3);
+
+    // A terminate request only affects a single call.
+    s->Terminate();
+    EXPECT_EQ(s->Solve().first, solver::Result::kUnknown) << s->ID();
+
+    solver::Resources budget;
+    budget.conflicts = 1;
+    s->SetBudget(budget);
+    EXPECT_EQ(s->Solve().first, solver::Result::kUnknown) << s->ID();
+    EXPECT_EQ(s->GetUsage().conflicts, 1) << s->ID();
+
+    s->SetBudget(solver::Resources());
+    EXPECT_EQ(s->Solve().first, solver::Result::kUNSAT) << s->ID();
+  }
+}
+
+TEST(SolverTest, Names) {
+  solver::algorithm::Nop s;
+  solver::Var x1 = s.NewVar();
+  solver::Var a = s.NewVar("a");
+  solver::Var t = s.NewTempVar("s1_2");
+  solver::Var x4 = s.NewVar("4");
+  solver::Var x5 = s.NewVar();
+
+  // Anonymous variables, and those named after their ID, are named on demand.
+  EXPECT_TRUE(s.IsAnonymous(x1));
+  EXPECT_FALSE(s.IsAnonymous(a));
+  EXPECT_FALSE(s.IsAnonymous(t));
+  EXPECT_TRUE(s.IsAnonymous(x4));
+  EXPECT_TRUE(s.IsAnonymous(x5));
+  EXPECT_EQ(s.GetVarNames(),
+            (std::vector<std::string>{"1", "a", "s1_2$0", "4", "5"}));
+  EXPECT_TRUE(s.IsTemp(t));
+  EXPECT_FALSE(s.IsTemp(x5));
+
+  EXPECT_EQ(s.GetVar("1"), x1);
+  EXPECT_EQ(s.GetVar("a"), a);
+  EXPECT_EQ(s.GetVar("s1_2$0"), t);
+  EXPECT_EQ(s.GetVar("4"), x4);
+  EXPECT_EQ(s.NewOrGetVar("5"), x5);
+  EXPECT_EQ(s.NewOrGetVar("05"), solver::Var(6));
+  EXPECT_EQ(s.NewOrGetVar("2"), solver::Var(7));
+  EXPECT_EQ(s.NumVars(), 7);
+
+  // Names survive the hash table growing.
+  for (int i = 0; i < 100; ++i) {
+    s.NewVar("y" + std::to_string(i));
+  }
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(s.GetVar("y" + std::to_string(i)), solver::Var(8 + i));
+  }
+  EXPECT_EQ(s.GetVar("a"), a);
+
+  s.Reset();
+  EXPECT_EQ(s.NumVars(), 0);
+  EXPECT_EQ(s.NewVar("a"), solver::Var(1));
+  EXPECT_FALSE(s.IsTemp(solver::Var(1)));
+}
+
+TEST(NameTableTest, IDClash) {
+  // Variable 3 can't be named after its ID, nor its ID with a prime, which
+  // are the names of variables 1 and 2.
+  solver::NameTable names;
+  names.Add("3");
+  names.Add("3'");
+  names.Add("");
+  names.Add("4");
+  EXPECT_EQ(names.Get(3), "3''");
+  EXPECT_FALSE(names.IsAnonymous(3));
+  EXPECT_TRUE(names.IsAnonymous(4));
+  EXPECT_EQ(names.Find("3"), 1);
+  EXPECT_EQ(names.Find("3'"), 2);
+  EXPECT_EQ(names.Find("3''"), 3);
+  EXPECT_EQ(names.Find("4"), 4);
+
+  solver::algorithm::Nop s;
+  solver::Var x = s.NewVar("2");
+  solver::Var y = s.NewVar();
+  EXPECT_EQ(s.GetVar("2"), x);
+  EXPECT_EQ(s.NewOrGetVar("2"), x);
+  EXPECT_EQ(s.GetVar(s.NameOf(y)), y);
+  EXPECT_EQ(s.GetVarNames(), (std::vector<std::string>{"2", "2'"}));
+}
+
+TEST(SolverTest, Occurrences) {
+  // Checks the index against the clauses added so far, in order.
+  auto Check = [](solver::Solver &s) {
+    const auto &occ = s.Occurrences();
+    std::vector<std::vector<solver::CRef>> want(2 * s.NumVars() + 2);
+    for (const solver::CRef cr : s.GetClauses().Refs()) {
+      const auto c = s.GetClauses()[cr];
+      if (c.Learned() || s.GetClauses().IsFreed(cr)) {
+        continue;
+      }
+      for (const auto lit : c) {
+        want[lit.ID()].push_back(cr);
+      }
+    }
+    for (int l = 2; l < 2 * s.NumVars() + 2; ++l) {
+      const auto got = occ.Occurrences(l);
+      EXPECT_EQ(std::vector<solver::CRef>(got.begin(), got.end()), want[l])
+          << s.ToString(solver::Lit(l));
+      EXPECT_EQ(occ.Count(l), want[l].size());
+    }
+  };
+
+  solver::algorithm::C s;
+  enc::Pigeonhole(s, 4);
+  Check(s);
+
+  // New variables and clauses are merged into the index.
+  solver::Var y = s.NewVar("y");
+  s.AddClause({y, ~solver::Var(1)});
+  s.AddClause({~y, solver::Var(3), solver::Var(1)});
+  Check(s);
+
+  // Learned clauses are left out, even when the arena is compacted.
+  EXPECT_EQ(s.Solve().first, solver::Result::kUNSAT);
+  s.AddClause({y});
+  Check(s);
+
+  s.Reset();
+  s.AddClause({s.NewVar("a"), s.NewVar("b")});
+  Check(s);
+}
+
+TEST(SolverTest, RepeatedSolve) {
+  std::vector<std::unique_ptr<solver::Solver>> solvers;
+  solvers.push_back(std::make_unique<solver::algorithm::A>());
+  solvers.push_back(std::make_unique<solver::algorithm::A2>());
+  solvers.push_back(std::make_unique<solver::algorithm::B>());
+  solvers.push_back(std::make_unique<solver::algorithm::D>());
+  for (auto &s : solvers) {
+    solver::Var x = s->NewVar("x");
+    solver::Var y = s->NewVar("y");
+    solver::Var z = s->NewVar("z");
+    s->AddClause({x, y});
+    s->AddClause({~x, z});
+    for (int i = 0; i < 2; ++i) {
+      auto [res, sol] = s->Solve();
+      EXPECT_EQ(res, solver::Result::kSAT) << s->ID();
+      EXPECT_TRUE(s->Verify(sol)) << s->ID();
+    }
+    if (s->ID() == "A" || s->ID() == "B") {
+      // x ∨ y and ¬x ∨ z have 4 solutions over x, y and z.
+      EXPECT_EQ(s->SolveAll().second.size(), 4) << s->ID();
+      EXPECT_EQ(s->SolveAll().second.size(), 4) << s->ID();
+    }
+
+    // Adding clauses and variables invalidates what was compiled.
+    s->AddClause({~z});
+    s->AddClause({~y, s->NewVar("w")});
+    auto [res, sol] = s->Solve();
+    EXPECT_EQ(res, solver::Result::kSAT) << s->ID();
+    EXPECT_TRUE(s->Verify(sol)) << s->ID();
+    s->AddClause({~solver::Var(4)});
+    EXPECT_EQ(s->Solve().first, solver::Result::kUNSAT) << s->ID();
+
+    s->Reset();
+    enc::Pigeonhole(*s, 3);
+    EXPECT_EQ(s->Solve().first, solver::Result::kUNSAT) << s->ID();
+  }
+}
+
+TEST(ZTest, SolveAll) {
+  // Enough variables for the assignments to be split across threads.
+  solver::algorithm::Z z;
+  enc::Rand(z, 24, 80, 3);
+  solver::algorithm::B b;
+  CopyInstance(z, b);
+
+  auto [res, sol] = z.Solve();
+  EXPECT_EQ(res, b.Solve().first);
+  if (res == solver::Result::kSAT) {
+    EXPECT_TRUE(z.Verify(sol));
+  }
+  auto all = z.SolveAll().second;
+  auto expected = b.SolveAll().second;
+  // Streamed in the order they're listed in, whichever thread found them.
+  std::vector<solver::Assignment> streamed;
+  z.SolveAll([&](const solver::Assignment &sol) {
+    streamed.push_back(sol);
+    return true;
+  });
+  EXPECT_EQ(streamed, all);
+  std::sort(all.begin(), all.end());
+  std::sort(expected.begin(), expected.end());
+  EXPECT_EQ(all, expected);
+}
+
+TEST(ParallelTest, SolveAll) {
+  std::vector<std::unique_ptr<solver::Solver>> solvers;
+  solvers.push_back(std::make_unique<solver::algorithm::Parallel>(
+      []() { return std::make_unique<solver::algorithm::A>(); }, 4));
+  solvers.push_back(std::make_unique<solver::algorithm::Parallel>(
+      []() { return std::make_unique<solver::algorithm::B>(); }, 4));
+  for (auto &s : solvers) {
+    enc::Rand(*s, 12, 30, 3);
+    solver::algorithm::B b;
+    CopyInstance(*s, b);
+
+    auto [res, all] = s->SolveAll();
+    auto expected = b.SolveAll().second;
+    EXPECT_EQ(res, b.Solve().first) << s->ID();
+    for (const auto &sol : all) {
+      EXPECT_TRUE(s->Verify(sol)) << s->ID();
+    }
+    std::sort(all.begin(), all.end());
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(all, expected) << s->ID();
+  }
+}
+
+TEST(CubeAndConquerTest, Split) {
+  // Every model satisfies exactly one cube.
+  for (int i = 0; i < 50; ++i) {
+    solver::algorithm::CubeAndConquer cc(1, 4);
+    enc::Rand(cc, 14, 50, 3);
+    solver::algorithm::B b;
+    CopyInstance(cc, b);
+    const auto cubes = cc.Split();
+    EXPECT_LE(cubes.size(), 16);
+    const auto [res, models] = b.SolveAll();
+    if (res == solver::Result::kUNSAT) {
+      continue;
+    }
+    for (const auto &model : models) {
+      int covering = 0;
+      for (const auto &cube : cubes) {
+        covering += std::all_of(cube.begin(), cube.end(), [&](solver::Lit l) {
+          return model[l.VID() - 1] == l;
+        });
+      }
+      EXPECT_EQ(covering, 1);
+    }
+  }
+
+  // The lookahead alone refutes small instances.
+  solver::algorithm::CubeAndConquer cc(1, 10);
+  enc::Pigeonhole(cc, 3);
+  EXPECT_TRUE(cc.Split().empty());
+}
+
+TEST(ClauseRingTest, PushPull) {
+  solver::ClauseRing ring(4);
+  solver::ClauseRing::Cursor c0 = 0;
+  solver::ClauseRing::Cursor c1 = 0;
+  std::vector<std::pair<solver::Clause, uint32_t>> out;
+  EXPECT_TRUE(ring.Push(0, {solver::Lit(2), solver::Lit(5)}, 2));
+  EXPECT_TRUE(ring.Push(1, {solver::Lit(7)}, 1));
+  EXPECT_FALSE(ring.Push(1, solver::Clause(17, solver::Lit(2)), 3));
+
+  // Sources don't read their own clauses.
+  ring.Pull(0, c0, out);
+  EXPECT_EQ(out, (std::vector<std::pair<solver::Clause, uint32_t>>{
+                     {{solver::Lit(7)}, 1}}));
+  out.clear();
+  ring.Pull(1, c1, out);
+  EXPECT_EQ(out, (std::vector<std::pair<solver::Clause, uint32_t>>{
+                     {{solver::Lit(2), solver::Lit(5)}, 2}}));
+  out.clear();
+  ring.Pull(1, c1, out);
+  EXPECT_TRUE(out.empty());
+
+  // Readers lapped by the writers miss the clauses overwritten.
+  for (int i = 1; i <= 10; ++i) {
+    EXPECT_TRUE(ring.Push(1, {solver::Lit(2 * i)}, 1));
+  }
+  ring.Pull(0, c0, out);
+  ASSERT_EQ(out.size(), 4);
+  EXPECT_EQ(out.front().first, solver::Clause{solver::Lit(14)});
+  EXPECT_EQ(out.back().first, solver::Clause{solver::Lit(20)});
+}
+
+TEST(ClauseRingTest, Threads) {
+  // Writers publish clauses whose literals all encode the same number, so that
+  // clauses read partially overwritten would be noticed.
+  constexpr int kWriters = 4;
+  constexpr int kClauses = 20000;
+  solver::ClauseRing ring(64);
+  std::atomic<int> done(0);
+  std::vector<std::thread> writers;
+  for (int w = 0; w < kWriters; ++w) {
+    writers.emplace_back([&, w]() {
+      for (int i = 0; i < kClauses; ++i) {
+        const int v = 2 * (w * kClauses + i + 1);
+        ring.Push(w, solver::Clause(1 + i % 16, solver::Lit(v)), i % 16);
+      }
+      ++done;
+    });
+  }
+  solver::ClauseRing::Cursor cursor = 0;
+  std::vector<std::pair<solver::Clause, uint32_t>> out;
+  size_t read = 0;
+  while (done < kWriters || !out.empty()) {
+    out.clear();
+    ring.Pull(-1, cursor, out);
+    for (const auto &[c, lbd] : out) {
+      ASSERT_EQ(c.size(), lbd + 1);
+      for (const auto &lit : c) {
+        ASSERT_EQ(lit, c[0]);
+      }
+    }
+    read += out.size();
+  }
+  for (auto &t : writers) {
+    t.join();
+  }
+  EXPECT_GT(read, 0);
+}
+
+TEST(ClauseRingTest, Dropped) {
+  // Writers lapping each other on a tiny ring drop clauses whose slot is still
+  // held by a slower writer, which mustn't hold readers back: once the writers
+  // are done, the last lap is read whole.
+  constexpr int kWriters = 4;
+  constexpr int kClauses = 2000;
+  for (int round = 0; round < 50; ++round) {
+    solver::ClauseRing ring(2);
+    std::vector<std::thread> writers;
+    for (int w = 0; w < kWriters; ++w) {
+      writers.emplace_back([&, w]() {
+        for (int i = 0; i < kClauses; ++i) {
+          ring.Push(w, solver::Clause(16, solver::Lit(2 * (i + 1))), 1);
+        }
+      });
+    }
+    for (auto &t : writers) {
+      t.join();
+    }
+    solver::ClauseRing::Cursor cursor = 0;
+    std::vector<std::pair<solver::Clause, uint32_t>> out;
+    ring.Pull(-1, cursor, out);
+    EXPECT_EQ(cursor, kWriters * kClauses);
+  }
+}
+
+TEST(RaceTest, Check) {
+  // The budget is checked against the propagations counted so far, and the
+  // first check over it stops the race once.
+  int64_t last = 0;
+  int calls = 0;
+  solver::algorithm::Race race([&](int64_t conflicts, int64_t propagations) {
+    EXPECT_EQ(conflicts, 0);
+    last = propagations;
+    ++calls;
+    return propagations >= 10;
+  });
+  std::vector<int> ran(4, 0);
+  solver::algorithm::Race::Run(4, [&](int i) {
+    std::lock_guard<std::mutex> lock(race.mu);
+    ++ran[i];
+    race.Check(5);
+  });
+  EXPECT_EQ(ran, std::vector<int>(4, 1));
+  EXPECT_TRUE(race.Stopped());
+  EXPECT_TRUE(race.Interrupted());
+  EXPECT_EQ(last, 10);
+  EXPECT_EQ(calls, 2);
+}
+
+TEST(LocalSearchTest, Best) {
+  using solver::LocalSearch;
+  const solver::Lit x1(solver::Var(1));
+  const solver::Lit x2(solver::Var(2));
+  const solver::Lit x3(solver::Var(3));
+
+  // (x1) and (¬x1) can't both hold, while (x2 ∨ x3 ∨ x3) and (¬x2 ∨ ¬x3) can.
+  LocalSearch::Instance in(3);
+  in.Add({x1});
+  in.Add({~x1});
+  in.Add({x2, x3, x3});
+  in.Add({~x2, ~x3});
+  in.Add({x1, ~x1, x2});
+  in.Index();
+  EXPECT_EQ(in.NumClauses(), 4);
+  EXPECT_EQ(in.maxSize, 2);
+  EXPECT_FALSE(in.empty);
+
+  for (auto mode : {LocalSearch::Mode::kWalkSAT, LocalSearch::Mode::kProbSAT}) {
+    // Starting with x2 and x3 both false or both true leaves two clauses
+    // false, and the walk soon finds values leaving only one.
+    for (char v : {0, 1}) {
+      LocalSearch walk(in, mode, 0.5, 7, {0, 0, v, v});
+      EXPECT_EQ(walk.NumUnsat(), 2);
+      EXPECT_FALSE(walk.Run(1000));
+      EXPECT_EQ(walk.BestUnsat(), 1);
+      EXPECT_NE(walk.Best()[2], walk.Best()[3]);
+    }
+  }
+}
+
+TEST(WTest, Incomplete) {
+  for (auto mode : {solver::algorithm::W::Mode::kWalkSAT,
+                    solver::algorithm::W::Mode::kProbSAT}) {
+    // Unsatisfiable instances keep the walks going until they run out of
+    // budget.
+    solver::algorithm::W w(mode, 2);
+    w.SetSeed(1);
+    enc::Pigeonhole(w, 4);
+    solver::Resources budget;
+    budget.propagations = 100000;
+    w.SetBudget(budget);
+    EXPECT_EQ(w.Solve().first, solver::Result::kUnknown);
+    EXPECT_GE(w.GetUsage().propagations, budget.propagations);
+    EXPECT_EQ(w.SolveAll().first, solver::Result::kUnknown);
+
+    w.SetBudget(solver::Resources());
+    w.Terminate();
+    EXPECT_EQ(w.Solve().first, solver::Result::kUnknown);
+
+    // Random 3SAT well below the threshold, almost surely satisfiable.
+    solver::algorithm::W r(mode);
+    enc::Rand(r, 200, 600, 3);
+    budget = solver::Resources();
+    budget.seconds = 60;
+    r.SetBudget(budget);
+    auto [res, sol] = r.Solve();
+    EXPECT_EQ(res, solver::Result::kSAT);
+    EXPECT_TRUE(r.Verify(sol));
+  }
+}
+
+TEST(LTest, Rand) {
+  // Random 3SAT and 4SAT around their thresholds, where both satisfiable and
+  // unsatisfiable instances are frequent.
+  for (auto [k, m] : std::vector<std::pair<int, int>>{
+           {3, 150}, {3, 170}, {3, 190}, {4, 360}, {4, 400}}) {
+    for (int i = 0; i < 10; ++i) {
+      solver::algorithm::C c;
+      enc::Rand(c, 40, m, k);
+      solver::algorithm::L l;
+      CopyInstance(c, l);
+      auto [res, sol] = l.Solve();
+      EXPECT_EQ(res, c.Solve().first) << c.ToString();
+      if (res == solver::Result::kSAT) {
+        EXPECT_TRUE(l.Verify(sol)) << c.ToString();
+      }
+    }
+  }
+}
+
+TEST(CounterTest, Rand) {
+  // Sparse instances split into many components, dense ones learn clauses.
+  for (int m : {8, 16, 32, 48, 64, 80}) {
+    for (int i = 0; i < 5; ++i) {
+      solver::algorithm::Z z;
+      enc::Rand(z, 16, m, 3);
+      solver::algorithm::Counter c;
+      CopyInstance(z, c);
+      auto [res, count] = c.Count();
+      auto [zres, all] = z.SolveAll();
+      EXPECT_EQ(res, zres) << z.ToString();
+      EXPECT_EQ(count, util::BigUint(all.size())) << z.ToString();
+    }
+  }
+}
+
+TEST(CounterTest, Count) {
+  // Langford pairs, counting reversals.
+  for (auto [n, want] : std::vector<std::pair<int, uint64_t>>{
+           {3, 2}, {4, 2}, {5, 0}, {7, 52}, {8, 300}}) {
+    solver::algorithm::Counter c;
+    enc::Langford(c, n);
+    auto [res, count] = c.Count();
+    EXPECT_EQ(res, want > 0 ? solver::Result::kSAT : solver::Result::kUNSAT)
+        << n;
+    EXPECT_EQ(count, util::BigUint(want)) << n;
+  }
+
+  // The chromatic polynomial of the Petersen graph.
+  for (auto [d, want] :
+       std::vector<std::pair<int, uint64_t>>{{2, 0}, {3, 120}, {4, 12960}}) {
+    solver::algorithm::Counter c;
+    enc::Coloring(c, d, enc::graph::Petersen());
+    EXPECT_EQ(c.Count().second, util::BigUint(want)) << d;
+  }
+
+  // Counts don't depend on the cache.
+  solver::algorithm::Counter c;
+  enc::Langford(c, 7);
+  c.SetCacheLimit(1);
+  EXPECT_EQ(c.Count().second, util::BigUint(52));
+
+  // Counts beyond 64 bits.
+  c.Reset();
+  std::vector<solver::Lit> x;
+  for (int i = 0; i < 100; ++i) {
+    x.push_back(c.NewVar());
+  }
+  EXPECT_EQ(c.Count().second.ToString(), "1267650600228229401496703205376");
+  c.AddClause({x[0], x[1]});
+  EXPECT_EQ(c.Count().second.ToString(), "950737950171172051122527404032");
+
+  c.Reset();
+  enc::Pigeonhole(c, 5);
+  EXPECT_EQ(c.Count().first, solver::Result::kUNSAT);
+  EXPECT_EQ(c.Count().second, util::BigUint(0));
+}
+
+TEST(SolverTest, SolveAllStreaming) {
+  std::vector<std::unique_ptr<solver::Solver>> solvers;
+  solvers.push_back(std::make_unique<solver::algorithm::A>());
+  solvers.push_back(std::make_unique<solver::algorithm::B>());
+  solvers.push_back(std::make_unique<solver::algorithm::C>());
+  solvers.push_back(std::make_unique<solver::algorithm::Z>());
+  solvers.push_back(std::make_unique<solver::algorithm::Parallel>(
+      []() { return std::make_unique<solver::algorithm::B>(); }, 4));
+  for (auto &s : solvers) {
+    // At most one of 10 variables is true: 11 solutions.
+    std::vector<solver::Lit> x;
+    for (int i = 0; i < 10; ++i) {
+      x.push_back(s->NewVar());
+    }
+    for (int i = 0; i < 10; ++i) {
+      for (int j = i + 1; j < 10; ++j) {
+        s->AddClause({~x[i], ~x[j]});
+      }
+    }
+
+    std::vector<solver::Assignment> streamed;
+    auto res = s->SolveAll([&](const solver::Assignment &sol) {
+      streamed.push_back(sol);
+      return true;
+    });
+    EXPECT_EQ(res, solver::Result::kSAT) << s->ID();
+    EXPECT_EQ(streamed.size(), 11) << s->ID();
+    auto all = s->SolveAll().second;
+    std::sort(all.begin(), all.end());
+    std::sort(streamed.begin(), streamed.end());
+    EXPECT_EQ(streamed, all) << s->ID();
+
+    // The search stops as soon as the function returns false.
+    int calls = 0;
+    res = s->SolveAll([&](const solver::Assignment &sol) {
+      EXPECT_TRUE(s->Verify(sol)) << s->ID();
+      return ++calls < 3;
+    });
+    EXPECT_EQ(res, solver::Result::kSAT) << s->ID();
+    EXPECT_EQ(calls, 3) << s->ID();
+
+    s->AddClause({x[0]});
+    s->AddClause({x[1]});
+    res = s->SolveAll([&](const solver::Assignment &) { return true; });
+    EXPECT_EQ(res, solver::Result::kUNSAT) << s->ID();
+  }
+}
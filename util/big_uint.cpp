@@ -0,0 +1,110 @@
+#include "big_uint.h"
+
+#include <algorithm>
+
+namespace util {
+
+BigUint::BigUint(uint64_t v) {
+  while (v != 0) {
+    limbs_.push_back(static_cast<uint32_t>(v));
+    v >>= 32;
+  }
+}
+
+BigUint &BigUint::operator+=(const BigUint &that) {
+  if (limbs_.size() < that.limbs_.size()) {
+    limbs_.resize(that.limbs_.size(), 0);
+  }
+  uint64_t carry = 0;
+  for (size_t i = 0; i < limbs_.size(); ++i) {
+    if (carry == 0 && i >= that.limbs_.size()) {
+      break;
+    }
+    carry += limbs_[i];
+    if (i < that.limbs_.size()) {
+      carry += that.limbs_[i];
+    }
+    limbs_[i] = static_cast<uint32_t>(carry);
+    carry >>= 32;
+  }
+  if (carry != 0) {
+    limbs_.push_back(static_cast<uint32_t>(carry));
+  }
+  return *this;
+}
+
+BigUint &BigUint::operator*=(const BigUint &that) {
+  if (IsZero() || that.IsZero()) {
+    limbs_.clear();
+    return *this;
+  }
+  std::vector<uint32_t> r(limbs_.size() + that.limbs_.size(), 0);
+  for (size_t i = 0; i < limbs_.size(); ++i) {
+    uint64_t carry = 0;
+    for (size_t j = 0; j < that.limbs_.size(); ++j) {
+      carry += static_cast<uint64_t>(limbs_[i]) * that.limbs_[j] + r[i + j];
+      r[i + j] = static_cast<uint32_t>(carry);
+      carry >>= 32;
+    }
+    r[i + that.limbs_.size()] = static_cast<uint32_t>(carry);
+  }
+  limbs_.swap(r);
+  Trim();
+  return *this;
+}
+
+BigUint &BigUint::operator<<=(size_t bits) {
+  if (IsZero()) {
+    return *this;
+  }
+  const size_t words = bits / 32;
+  const int shift = static_cast<int>(bits % 32);
+  if (shift != 0) {
+    uint32_t carry = 0;
+    for (auto &limb : limbs_) {
+      const uint32_t next = limb >> (32 - shift);
+      limb = (limb << shift) | carry;
+      carry = next;
+    }
+    if (carry != 0) {
+      limbs_.push_back(carry);
+    }
+  }
+  limbs_.insert(limbs_.begin(), words, 0);
+  return *this;
+}
+
+std::string BigUint::ToString() const {
+  if (IsZero()) {
+    return "0";
+  }
+  // Peel off 9 decimal digits at a time by dividing by 10^9.
+  constexpr uint32_t kBase = 1000000000;
+  std::vector<uint32_t> q = limbs_;
+  std::string s;
+  while (!q.empty()) {
+    uint64_t rem = 0;
+    for (size_t i = q.size(); i-- > 0;) {
+      const uint64_t cur = (rem << 32) | q[i];
+      q[i] = static_cast<uint32_t>(cur / kBase);
+      rem = cur % kBase;
+    }
+    while (!q.empty() && q.back() == 0) {
+      q.pop_back();
+    }
+    for (int i = 0; i < 9 && (!q.empty() || rem != 0); ++i) {
+      s.push_back(static_cast<char>('0' + rem % 10));
+      rem /= 10;
+    }
+  }
+  std::reverse(s.begin(), s.end());
+  return s;
+}
+
+void BigUint::Trim() {
+  while (!limbs_.empty() && limbs_.back() == 0) {
+    limbs_.pop_back();
+  }
+}
+
+} // namespace util
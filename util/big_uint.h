@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace util {
+
+// An arbitrary-precision unsigned integer, for counts that overflow 64 bits,
+// such as numbers of models. It's stored as 32-bit limbs, least significant
+// first, without leading zero limbs.
+class BigUint {
+public:
+  BigUint(uint64_t v = 0);
+
+  bool IsZero() const { return limbs_.empty(); }
+
+  BigUint &operator+=(const BigUint &);
+  BigUint &operator*=(const BigUint &);
+  // Multiplies by 2^bits.
+  BigUint &operator<<=(size_t bits);
+
+  bool operator==(const BigUint &that) const { return limbs_ == that.limbs_; }
+  bool operator!=(const BigUint &that) const { return limbs_ != that.limbs_; }
+
+  // Number of bytes held, for accounting memory.
+  size_t Bytes() const { return limbs_.capacity() * sizeof(uint32_t); }
+
+  // Decimal representation.
+  std::string ToString() const;
+
+private:
+  std::vector<uint32_t> limbs_;
+
+  void Trim();
+};
+
+inline BigUint operator+(BigUint a, const BigUint &b) { return a += b; }
+inline BigUint operator*(BigUint a, const BigUint &b) { return a *= b; }
+inline BigUint operator<<(BigUint a, size_t bits) { return a <<= bits; }
+
+inline std::ostream &operator<<(std::ostream &os, const BigUint &v) {
+  return os << v.ToString();
+}
+
+} // namespace util
@@ -0,0 +1,270 @@
+#include "decompressed_file.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include <bzlib.h>
+#include <lzma.h>
+#include <zlib.h>
+
+namespace util {
+
+namespace {
+
+// Size of the blocks read from the file and handed out to the reader.
+constexpr size_t kBlockBytes = 1 << 20;
+
+// Maximum number of decompressed blocks waiting for the reader.
+constexpr size_t kMaxPending = 8;
+
+// Receives a block of decompressed data, returning false if decompression must
+// stop.
+using Sink = std::function<bool(std::string &)>;
+
+bool EndsWith(const std::string &s, const std::string &suffix) {
+  return s.size() >= suffix.size() &&
+         s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Reads the next piece of compressed input into buf, returning its size. Sets
+// err on failure.
+size_t ReadInput(FILE *f, std::vector<unsigned char> &buf, std::string &err) {
+  const size_t n = std::fread(buf.data(), 1, buf.size(), f);
+  if (n == 0 && std::ferror(f)) {
+    err = std::string("failed to read compressed file: ") +
+          std::strerror(errno);
+  }
+  return n;
+}
+
+// Each of the decoders below supports concatenated streams, as produced e.g.
+// by parallel compressors, and returns an error message or an empty string.
+
+std::string DecodeGzip(FILE *f, const Sink &emit) {
+  z_stream zs{};
+  // Accept both gzip and zlib headers.
+  if (inflateInit2(&zs, 15 + 32) != Z_OK) {
+    return "failed to initialize gzip decoder";
+  }
+  std::vector<unsigned char> in(kBlockBytes);
+  std::string err;
+  bool inStream = false;
+  while (err.empty()) {
+    if (zs.avail_in == 0) {
+      zs.avail_in = ReadInput(f, in, err);
+      zs.next_in = in.data();
+      if (zs.avail_in == 0) {
+        if (err.empty() && inStream) {
+          err = "unexpected end of gzip data";
+        }
+        break;
+      }
+    }
+    std::string out(kBlockBytes, '\0');
+    zs.next_out = reinterpret_cast<Bytef *>(out.data());
+    zs.avail_out = out.size();
+    const int ret = inflate(&zs, Z_NO_FLUSH);
+    inStream = true;
+    out.resize(out.size() - zs.avail_out);
+    if (!out.empty() && !emit(out)) {
+      break;
+    }
+    if (ret == Z_STREAM_END) {
+      inflateReset(&zs);
+      inStream = false;
+    } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+      err = std::string("invalid gzip data: ") + (zs.msg ? zs.msg : "?");
+    }
+  }
+  inflateEnd(&zs);
+  return err;
+}
+
+std::string DecodeXz(FILE *f, const Sink &emit) {
+  lzma_stream xz = LZMA_STREAM_INIT;
+  if (lzma_stream_decoder(&xz, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK) {
+    return "failed to initialize xz decoder";
+  }
+  std::vector<unsigned char> in(kBlockBytes);
+  std::string err;
+  lzma_action action = LZMA_RUN;
+  while (err.empty()) {
+    if (xz.avail_in == 0 && action == LZMA_RUN) {
+      xz.avail_in = ReadInput(f, in, err);
+      xz.next_in = in.data();
+      if (xz.avail_in == 0) {
+        action = LZMA_FINISH;
+      }
+    }
+    std::string out(kBlockBytes, '\0');
+    xz.next_out = reinterpret_cast<uint8_t *>(out.data());
+    xz.avail_out = out.size();
+    const lzma_ret ret = lzma_code(&xz, action);
+    out.resize(out.size() - xz.avail_out);
+    if (!out.empty() && !emit(out)) {
+      break;
+    }
+    if (ret == LZMA_STREAM_END) {
+      break;
+    } else if (ret != LZMA_OK) {
+      err = "invalid xz data: error " + std::to_string(ret);
+    }
+  }
+  lzma_end(&xz);
+  return err;
+}
+
+std::string DecodeBzip2(FILE *f, const Sink &emit) {
+  bz_stream bz{};
+  if (BZ2_bzDecompressInit(&bz, 0, 0) != BZ_OK) {
+    return "failed to initialize bzip2 decoder";
+  }
+  std::vector<unsigned char> in(kBlockBytes);
+  std::string err;
+  bool inStream = false;
+  while (err.empty()) {
+    if (bz.avail_in == 0) {
+      bz.avail_in = ReadInput(f, in, err);
+      bz.next_in = reinterpret_cast<char *>(in.data());
+      if (bz.avail_in == 0) {
+        if (err.empty() && inStream) {
+          err = "unexpected end of bzip2 data";
+        }
+        break;
+      }
+    }
+    std::string out(kBlockBytes, '\0');
+    bz.next_out = out.data();
+    bz.avail_out = out.size();
+    const int ret = BZ2_bzDecompress(&bz);
+    inStream = true;
+    out.resize(out.size() - bz.avail_out);
+    if (!out.empty() && !emit(out)) {
+      break;
+    }
+    if (ret == BZ_STREAM_END) {
+      // Restart the decoder for the next stream, keeping the pending input.
+      char *next = bz.next_in;
+      const unsigned int avail = bz.avail_in;
+      BZ2_bzDecompressEnd(&bz);
+      bz = bz_stream{};
+      if (BZ2_bzDecompressInit(&bz, 0, 0) != BZ_OK) {
+        return "failed to initialize bzip2 decoder";
+      }
+      bz.next_in = next;
+      bz.avail_in = avail;
+      inStream = false;
+    } else if (ret != BZ_OK) {
+      err = "invalid bzip2 data: error " + std::to_string(ret);
+    }
+  }
+  BZ2_bzDecompressEnd(&bz);
+  return err;
+}
+
+} // namespace
+
+Compression DetectCompression(const std::string &path) {
+  unsigned char magic[6] = {};
+  if (FILE *f = std::fopen(path.c_str(), "rb")) {
+    const size_t n = std::fread(magic, 1, sizeof(magic), f);
+    std::fclose(f);
+    if (n >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+      return Compression::kGzip;
+    }
+    if (n >= 6 && std::memcmp(magic, "\xfd" "7zXZ\0", 6) == 0) {
+      return Compression::kXz;
+    }
+    if (n >= 3 && std::memcmp(magic, "BZh", 3) == 0) {
+      return Compression::kBzip2;
+    }
+    if (n > 0) {
+      return Compression::kNone;
+    }
+  }
+  if (EndsWith(path, ".gz")) {
+    return Compression::kGzip;
+  }
+  if (EndsWith(path, ".xz")) {
+    return Compression::kXz;
+  }
+  if (EndsWith(path, ".bz2")) {
+    return Compression::kBzip2;
+  }
+  return Compression::kNone;
+}
+
+DecompressedFile::~DecompressedFile() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  if (file_ != nullptr) {
+    std::fclose(file_);
+  }
+}
+
+std::string DecompressedFile::Open(const std::string &path,
+                                   Compression compression) {
+  file_ = std::fopen(path.c_str(), "rb");
+  if (file_ == nullptr) {
+    return "failed to open " + path + ": " + std::strerror(errno);
+  }
+  thread_ = std::thread(&DecompressedFile::Run, this, compression);
+  return "";
+}
+
+bool DecompressedFile::Next(std::string &block) {
+  std::unique_lock<std::mutex> lock(mu_);
+  cv_.wait(lock, [this]() { return !blocks_.empty() || done_; });
+  if (blocks_.empty()) {
+    return false;
+  }
+  block = std::move(blocks_.front());
+  blocks_.pop_front();
+  cv_.notify_all();
+  return true;
+}
+
+bool DecompressedFile::Emit(std::string &block) {
+  std::unique_lock<std::mutex> lock(mu_);
+  cv_.wait(lock, [this]() { return blocks_.size() < kMaxPending || stop_; });
+  if (stop_) {
+    return false;
+  }
+  blocks_.push_back(std::move(block));
+  cv_.notify_all();
+  return true;
+}
+
+void DecompressedFile::Run(Compression compression) {
+  const Sink emit = [this](std::string &block) { return Emit(block); };
+  std::string err;
+  switch (compression) {
+  case Compression::kGzip:
+    err = DecodeGzip(file_, emit);
+    break;
+  case Compression::kXz:
+    err = DecodeXz(file_, emit);
+    break;
+  case Compression::kBzip2:
+    err = DecodeBzip2(file_, emit);
+    break;
+  case Compression::kNone:
+    err = "file is not compressed";
+    break;
+  }
+  std::lock_guard<std::mutex> lock(mu_);
+  err_ = err;
+  done_ = true;
+  cv_.notify_all();
+}
+
+} // namespace util
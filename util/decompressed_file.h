@@ -0,0 +1,61 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace util {
+
+enum class Compression {
+  kNone,
+  kGzip,
+  kXz,
+  kBzip2,
+};
+
+// Returns the compression format of the file at path, detected by its magic
+// bytes or, failing that, by its extension.
+Compression DetectCompression(const std::string &path);
+
+// A compressed file decompressed on a background thread, so that decompression
+// overlaps with whatever the reader does with the data. Decompressed data is
+// handed out in blocks, in order, and at most a few blocks are buffered ahead
+// of the reader.
+class DecompressedFile {
+public:
+  DecompressedFile() : file_(nullptr), done_(false), stop_(false) {}
+  ~DecompressedFile();
+
+  DecompressedFile(const DecompressedFile &) = delete;
+  DecompressedFile &operator=(const DecompressedFile &) = delete;
+
+  // Opens the file at path and starts decompressing it. Returns an error
+  // message on failure, or an empty string otherwise.
+  std::string Open(const std::string &path, Compression);
+
+  // Waits for the next block of decompressed data and moves it into block.
+  // Returns false once all the data has been read or decompression failed, in
+  // which case Error tells which.
+  bool Next(std::string &block);
+
+  // Reason decompression failed, or an empty string if it didn't.
+  const std::string &Error() const { return err_; }
+
+private:
+  FILE *file_;
+  std::thread thread_;
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<std::string> blocks_;
+  bool done_;
+  bool stop_;
+  std::string err_;
+
+  void Run(Compression);
+  bool Emit(std::string &block);
+};
+
+} // namespace util
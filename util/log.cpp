@@ -2,12 +2,26 @@
 
 #include <cstdlib>
 #include <iostream>
+#include <mutex>
 #include <string>
 
 namespace util {
 
 DimacsStream stream;
 
+namespace {
+
+// Messages are built in a buffer of their thread and written whole, so that
+// several threads can log at once.
+std::stringstream &Buffer() {
+  thread_local std::stringstream out;
+  return out;
+}
+
+std::mutex mu;
+
+} // namespace
+
 DimacsStream::DimacsMessage::DimacsMessage(char h, std::stringstream &out)
     : out_(out) {
   // out_ << "\033[1;31m";
@@ -16,6 +30,7 @@ DimacsStream::DimacsMessage::DimacsMessage(char h, std::stringstream &out)
 
 DimacsStream::DimacsMessage::~DimacsMessage() {
   // out_ << "\033[0m";
+  std::lock_guard<std::mutex> lock(mu);
   std::cout << out_.str() << '\n';
   out_.str(std::string(""));
 }
@@ -29,17 +44,18 @@ DimacsStream::FatalMessage::FatalMessage(std::stringstream &out,
 }
 
 DimacsStream::FatalMessage::~FatalMessage() {
+  std::lock_guard<std::mutex> lock(mu);
   std::cerr << out_.str() << std::endl;
   std::abort();
 }
 
 DimacsStream::DimacsMessage DimacsStream::Emit(char h) {
-  return DimacsStream::DimacsMessage(h, stream_);
+  return DimacsStream::DimacsMessage(h, Buffer());
 }
 
 DimacsStream::FatalMessage DimacsStream::Fatal(const char *file, int line,
                                                const char *cond) {
-  return DimacsStream::FatalMessage(stream_, file, line, cond);
+  return DimacsStream::FatalMessage(Buffer(), file, line, cond);
 }
 
 DimacsStream::DimacsMessage DimacsStream::Comment() { return Emit('c'); }
@@ -41,8 +41,6 @@ public:
   DimacsMessage Result();
 
 private:
-  std::stringstream stream_;
-
   DimacsMessage Emit(char h);
 };
 
@@ -0,0 +1,51 @@
+#include "mapped_file.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace util {
+
+MappedFile::~MappedFile() { Close(); }
+
+std::string MappedFile::Open(const std::string &path) {
+  Close();
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return "failed to open " + path + ": " + std::strerror(errno);
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    const std::string err = std::strerror(errno);
+    ::close(fd);
+    return "failed to stat " + path + ": " + err;
+  }
+  // Empty files can't be mapped, but there's nothing to read anyway.
+  if (st.st_size > 0) {
+    void *addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+      const std::string err = std::strerror(errno);
+      ::close(fd);
+      return "failed to map " + path + ": " + err;
+    }
+    ::madvise(addr, st.st_size, MADV_SEQUENTIAL);
+    data_ = static_cast<const char *>(addr);
+    size_ = st.st_size;
+  }
+  ::close(fd);
+  return "";
+}
+
+void MappedFile::Close() {
+  if (data_ != nullptr) {
+    ::munmap(const_cast<char *>(data_), size_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+}
+
+} // namespace util
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace util {
+
+// A read-only memory mapping of a whole file. The mapping is released when the
+// object is destroyed.
+class MappedFile {
+public:
+  MappedFile() : data_(nullptr), size_(0) {}
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  // Maps the file at path, replacing any previous mapping. Returns an error
+  // message on failure, or an empty string otherwise.
+  std::string Open(const std::string &path);
+
+  const char *data() const { return data_; }
+  size_t size() const { return size_; }
+
+private:
+  const char *data_;
+  size_t size_;
+
+  void Close();
+};
+
+} // namespace util
@@ -0,0 +1,87 @@
+#include "work_stealing_pool.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace util {
+
+WorkStealingPool::WorkStealingPool(int numThreads)
+    : pending_(0), pushes_(0) {
+  for (int i = 0; i < std::max(1, numThreads); ++i) {
+    queues_.push_back(std::make_unique<Queue>());
+  }
+}
+
+void WorkStealingPool::Push(int worker, Task task) {
+  ++pending_;
+  {
+    auto &q = *queues_[worker];
+    std::lock_guard<std::mutex> lock(q.mu);
+    q.tasks.push_back(std::move(task));
+  }
+  {
+    std::lock_guard<std::mutex> lock(idleMu_);
+    ++pushes_;
+  }
+  idle_.notify_one();
+}
+
+void WorkStealingPool::Run() {
+  std::vector<std::thread> threads;
+  for (int i = 1; i < NumThreads(); ++i) {
+    threads.emplace_back(&WorkStealingPool::Work, this, i);
+  }
+  Work(0);
+  for (auto &t : threads) {
+    t.join();
+  }
+}
+
+void WorkStealingPool::Work(int worker) {
+  Task task;
+  while (true) {
+    // Tasks pushed after this point wake the worker up if it finds nothing.
+    const uint64_t seen = pushes_.load();
+    if (Pop(worker, task) || Steal(worker, task)) {
+      task(worker);
+      task = nullptr;
+      // Done only after running it, since it may have spawned more tasks.
+      if (--pending_ == 0) {
+        std::lock_guard<std::mutex> lock(idleMu_);
+        idle_.notify_all();
+      }
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(idleMu_);
+    idle_.wait(lock, [&]() { return pending_ == 0 || pushes_ != seen; });
+    if (pending_ == 0) {
+      return;
+    }
+  }
+}
+
+bool WorkStealingPool::Pop(int worker, Task &task) {
+  auto &q = *queues_[worker];
+  std::lock_guard<std::mutex> lock(q.mu);
+  if (q.tasks.empty()) {
+    return false;
+  }
+  task = std::move(q.tasks.back());
+  q.tasks.pop_back();
+  return true;
+}
+
+bool WorkStealingPool::Steal(int worker, Task &task) {
+  for (int i = 1; i < NumThreads(); ++i) {
+    auto &q = *queues_[(worker + i) % NumThreads()];
+    std::lock_guard<std::mutex> lock(q.mu);
+    if (!q.tasks.empty()) {
+      task = std::move(q.tasks.front());
+      q.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace util
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace util {
+
+// A pool of threads running tasks that may spawn more tasks. Each thread has
+// its own deque of tasks: it pushes the tasks it spawns and pops the next one
+// at the back, so it goes depth-first, and once it runs out it steals from the
+// front of the others', where the oldest and usually largest tasks are.
+// Workers finding nothing to steal sleep until more tasks are pushed.
+class WorkStealingPool {
+public:
+  // Tasks are given the index of the worker running them.
+  using Task = std::function<void(int worker)>;
+
+  explicit WorkStealingPool(int numThreads);
+
+  WorkStealingPool(const WorkStealingPool &) = delete;
+  WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+  int NumThreads() const { return static_cast<int>(queues_.size()); }
+
+  // Adds a task to the deque of the given worker. Tasks running in the pool
+  // push the tasks they spawn to their own worker.
+  void Push(int worker, Task);
+
+  // Runs tasks on the calling thread, as worker 0, and on NumThreads()-1 more
+  // threads until there are none left, and returns once every task is done.
+  void Run();
+
+private:
+  struct Queue {
+    std::mutex mu;
+    std::deque<Task> tasks;
+  };
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  // Number of tasks pushed but not yet finished.
+  std::atomic<int64_t> pending_;
+  // Idle workers wait on idle_ until a task is pushed, which bumps pushes_,
+  // or every task is done. Both are changed with idleMu_ held, so that a
+  // worker can't miss them between checking and waiting.
+  std::mutex idleMu_;
+  std::condition_variable idle_;
+  std::atomic<uint64_t> pushes_;
+
+  void Work(int worker);
+  bool Pop(int worker, Task &);
+  bool Steal(int worker, Task &);
+};
+
+} // namespace util